@@ -0,0 +1,91 @@
+/**
+ * @file frame_context.cpp
+ * @brief The Per-Frame Transient Buffers of the Render Loop
+ */
+
+#include "frame_context.h"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+
+GSTileSplatterAccelProxy FrameResources::accel() noexcept
+{
+    return {
+        .tiles_touched = tiles_touched,
+        .point_offsets = point_offsets,
+        .ranges        = ranges,
+        .records       = records
+    };
+}
+
+GSSplatForwardOutputProxy FrameResources::output(int width, int height) noexcept
+{
+    return {
+        .height     = height,
+        .width      = width,
+        .target_img = img,
+        .radii      = radii
+    };
+}
+
+FrameContext::FrameContext(
+    Device& device,
+    uint    num_frames,
+    int     num_gaussians,
+    uint2   resolution,
+    uint2   grids
+) noexcept
+    : m_preprocessed{ device.create_timeline_event() }
+    , m_rendered{ device.create_timeline_event() }
+{
+    num_frames = std::max(num_frames, 1u);
+    auto P     = static_cast<size_t>(num_gaussians);
+    m_frames.reserve(num_frames);
+    for (auto i = 0u; i < num_frames; i++)
+    {
+        m_frames.emplace_back(FrameResources{
+            .means_2d       = device.create_buffer<float>(P * 2),
+            .depth_features = device.create_buffer<float>(P),
+            .covs_2d        = device.create_buffer<float>(P * 3),
+            .color          = device.create_buffer<float>(P * 3),
+            .visible_ids    = device.create_buffer<uint>(P),
+            .num_visible    = device.create_buffer<uint>(1),
+            .tiles_touched  = device.create_buffer<uint>(P),
+            .point_offsets  = device.create_buffer<uint>(P),
+            .records        = device.create_buffer<GSSplatRecord>(P),
+            .ranges         = device.create_buffer<uint>(grids.x * grids.y * 2),
+            .img            = device.create_buffer<float>(resolution.x * resolution.y * 3),
+            .radii          = device.create_buffer<int>(P) });
+    }
+    LUISA_INFO("FrameContext: {} frames in flight", num_frames);
+}
+
+FrameResources& FrameContext::begin_frame(Stream& preprocess_stream) noexcept
+{
+    // the set was last used by frame i - N, the preprocess must not overwrite it before that frame left the render stream
+    // the wait stays on the device, so the host keeps recording ahead
+    auto N = m_frames.size();
+    if (m_frame_index >= N)
+    {
+        preprocess_stream << m_rendered.wait(m_frame_index - N + 1u);
+    }
+    return current();
+}
+
+void FrameContext::hand_over(Stream& preprocess_stream, Stream& render_stream) noexcept
+{
+    if (&preprocess_stream == &render_stream) { return; }
+    preprocess_stream << m_preprocessed.signal(m_frame_index + 1u);
+    render_stream << m_preprocessed.wait(m_frame_index + 1u);
+}
+
+void FrameContext::end_frame(Stream& render_stream) noexcept
+{
+    render_stream << m_rendered.signal(m_frame_index + 1u);
+    m_frame_index++;
+}
+
+} // namespace lcgs
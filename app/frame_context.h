@@ -0,0 +1,67 @@
+#pragma once
+/**
+ * @file frame_context.h
+ * @brief The Per-Frame Transient Buffers of the Render Loop
+ */
+
+#include <luisa/luisa-compute.h>
+#include "lcgs/proxy.h"
+
+namespace lcgs
+{
+
+// the buffers one frame writes between its preprocess and its present
+struct FrameResources {
+    // preprocess, P
+    luisa::compute::Buffer<float>       means_2d;
+    luisa::compute::Buffer<float>       depth_features;
+    luisa::compute::Buffer<float>       covs_2d;
+    luisa::compute::Buffer<float>       color;
+    luisa::compute::Buffer<luisa::uint> visible_ids;
+    luisa::compute::Buffer<luisa::uint> num_visible;
+    // tile splatting
+    // the point lists are owned by the splatter, the frames reach it in submission order
+    luisa::compute::Buffer<luisa::uint>   tiles_touched;
+    luisa::compute::Buffer<luisa::uint>   point_offsets;
+    luisa::compute::Buffer<GSSplatRecord> records;
+    luisa::compute::Buffer<luisa::uint>   ranges;
+    // output
+    luisa::compute::Buffer<float> img;
+    luisa::compute::Buffer<int>   radii;
+
+    [[nodiscard]] GSTileSplatterAccelProxy  accel() noexcept;
+    [[nodiscard]] GSSplatForwardOutputProxy output(int width, int height) noexcept;
+};
+
+// N sets of FrameResources used round robin, so frame i + 1 is recorded and submitted
+// while frame i is still splatted or presented
+// frame i may reuse its set only after frame i - N has finished on the render stream
+class FrameContext
+{
+public:
+    FrameContext(
+        luisa::compute::Device& device,
+        luisa::uint             num_frames,
+        int                     num_gaussians,
+        luisa::uint2            resolution,
+        luisa::uint2            grids
+    ) noexcept;
+
+    // the preprocess stream waits until the set of this frame is free again
+    FrameResources& begin_frame(luisa::compute::Stream& preprocess_stream) noexcept;
+    // the render stream waits for the preprocess submitted on another stream
+    void            hand_over(luisa::compute::Stream& preprocess_stream, luisa::compute::Stream& render_stream) noexcept;
+    // marks the set busy until the render stream reaches this point
+    void            end_frame(luisa::compute::Stream& render_stream) noexcept;
+
+    [[nodiscard]] FrameResources& current() noexcept { return m_frames[m_frame_index % m_frames.size()]; }
+    [[nodiscard]] luisa::uint     num_frames() const noexcept { return static_cast<luisa::uint>(m_frames.size()); }
+
+private:
+    luisa::vector<FrameResources> m_frames;
+    luisa::compute::TimelineEvent m_preprocessed; // value i + 1 once the preprocess of frame i is done
+    luisa::compute::TimelineEvent m_rendered;     // value i + 1 once frame i left the render stream
+    uint64_t                      m_frame_index = 0u;
+};
+
+} // namespace lcgs
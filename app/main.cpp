@@ -13,10 +13,12 @@
 #include "command_parser.hpp"
 #include "gaussians.h"
 #include "lcgs/gs_projector.h"
-#include "lcgs/gs_tile_splatter.h"
+#include "lcgs/gs_fused_splatter.h"
+#include "frame_context.h"
 #include "lcgs/sh_preprocessor.h"
 #include "lcgs/util/buffer_filler.h"
 #include "lcgs/util/camera.h"
+#include "lcgs/util/image_metric.h"
 #include <lcpp/device/device_scan.h>
 #include <lcpp/device/device_radix_sort.h>
 #include "luisa/runtime/rhi/stream_tag.h"
@@ -44,6 +46,18 @@ int main(int argc, char** argv)
     std::string    out_dir        = "out";
     WorldType      world_type     = WorldType::COLMAP;
     bool           should_display = false;
+    bool           sync_free      = false;
+    uint           depth_bits     = 32u;
+    lcgs::GSTileBinning binning   = lcgs::GSTileBinning::RadixSort;
+    luisa::uint2   pixels_per_thread = { 1u, 1u };
+    luisa::uint2   tile_size         = { 16u, 16u };
+    bool           fused             = false;
+    bool           temporal_order    = false;
+    uint           num_frames        = 1u;
+    bool           async_compute     = false;
+    lcgs::GSTileBlend blend          = lcgs::GSTileBlend::DepthSorted;
+    uint           tile_split_size   = 0u;
+    uint           persistent_blocks = 0u;
 
     int exp_N = 1;
 
@@ -61,6 +75,18 @@ int main(int argc, char** argv)
             LUISA_INFO("  --world <type>           Set the world type (colmap or blender, default: colmap)");
             LUISA_INFO("  --exp_N <N>              Set the number of experiments (default: {})", exp_N);
             LUISA_INFO("  --display                Enable gui display (default: off)");
+            LUISA_INFO("  --sync_free              Enqueue each frame without host readback, num_rendered is one frame late (default: off)");
+            LUISA_INFO("  --depth_bits <N>         Set the view depth bits kept in the sort key (default: {})", depth_bits);
+            LUISA_INFO("  --binning <type>         Set the tile binning (radix or counting, default: radix)");
+            LUISA_INFO("  --ppt <x>x<y>            Set the pixels shaded by one render thread (default: 1x1)");
+            LUISA_INFO("  --tile <x>x<y>           Set the tile size (default: {}x{})", tile_size.x, tile_size.y);
+            LUISA_INFO("  --fused                  Project and allocate tiles in one preprocess pass (default: off)");
+            LUISA_INFO("  --temporal               Reuse the depth order of the last frame, radix binning only (default: off)");
+            LUISA_INFO("  --frames <N>             Set the frames in flight, each with its own transient buffers (default: {})", num_frames);
+            LUISA_INFO("  --async_compute          Run SH and projection on a separate compute stream (default: off)");
+            LUISA_INFO("  --split <N>              Blend heavy tiles in chunks of about N splats by several blocks, 0 for off (default: {})", tile_split_size);
+            LUISA_INFO("  --persistent <N>         Launch at most N render blocks that pull tiles heaviest first, 0 for one per tile (default: {})", persistent_blocks);
+            LUISA_INFO("  --sort_free              Blend by weighted sum without a depth sort, reports the PSNR against the sorted blend (default: off)");
             exit(0);
         };
         cmds.emplace("help", help_fn);
@@ -120,6 +146,89 @@ int main(int argc, char** argv)
         cmds.emplace("display", [&](vstd::string_view) {
             should_display = true;
         });
+        cmds.emplace("fused", [&](vstd::string_view) {
+            fused = true;
+        });
+        cmds.emplace("temporal", [&](vstd::string_view) {
+            temporal_order = true;
+        });
+        cmds.emplace("frames", [&](vstd::string_view str) {
+            if (str.empty())
+            {
+                LUISA_ERROR("--frames requires a value");
+            }
+            num_frames = static_cast<uint>(std::stoi(std::string(str)));
+            if (num_frames == 0u)
+            {
+                LUISA_ERROR("--frames must be at least 1");
+            }
+        });
+        cmds.emplace("async_compute", [&](vstd::string_view) {
+            async_compute = true;
+        });
+        cmds.emplace("split", [&](vstd::string_view str) {
+            if (str.empty())
+            {
+                LUISA_ERROR("--split requires a value");
+            }
+            tile_split_size = static_cast<uint>(std::stoi(std::string(str)));
+        });
+        cmds.emplace("persistent", [&](vstd::string_view str) {
+            if (str.empty())
+            {
+                LUISA_ERROR("--persistent requires a value");
+            }
+            persistent_blocks = static_cast<uint>(std::stoi(std::string(str)));
+        });
+        cmds.emplace("sort_free", [&](vstd::string_view) {
+            blend = lcgs::GSTileBlend::WeightedSum;
+        });
+        cmds.emplace("sync_free", [&](vstd::string_view) {
+            sync_free = true;
+        });
+        cmds.emplace("depth_bits", [&](vstd::string_view str) {
+            if (str.empty())
+            {
+                LUISA_ERROR("--depth_bits requires a value");
+            }
+            depth_bits = static_cast<uint>(std::stoi(std::string(str)));
+        });
+        cmds.emplace("ppt", [&](vstd::string_view str) {
+            auto xpos = str.find('x');
+            if (xpos == vstd::string_view::npos)
+            {
+                LUISA_ERROR("Invalid pixel footprint format: '{}'. Expected <x>x<y>", str);
+            }
+            pixels_per_thread = luisa::make_uint2(
+                static_cast<uint>(std::stoi(std::string(str.substr(0, xpos)))),
+                static_cast<uint>(std::stoi(std::string(str.substr(xpos + 1))))
+            );
+        });
+        cmds.emplace("tile", [&](vstd::string_view str) {
+            auto xpos = str.find('x');
+            if (xpos == vstd::string_view::npos)
+            {
+                LUISA_ERROR("Invalid tile size format: '{}'. Expected <x>x<y>", str);
+            }
+            tile_size = luisa::make_uint2(
+                static_cast<uint>(std::stoi(std::string(str.substr(0, xpos)))),
+                static_cast<uint>(std::stoi(std::string(str.substr(xpos + 1))))
+            );
+        });
+        cmds.emplace("binning", [&](vstd::string_view str) {
+            if (str == "radix" || str.empty())
+            {
+                binning = lcgs::GSTileBinning::RadixSort;
+            }
+            else if (str == "counting")
+            {
+                binning = lcgs::GSTileBinning::CountingSort;
+            }
+            else
+            {
+                LUISA_ERROR("Invalid binning type: {}", str);
+            }
+        });
         // parse command
         parse_command(cmds, argc, argv, {});
     }
@@ -170,7 +279,7 @@ int main(int argc, char** argv)
     LUISA_INFO("num_gaussians: {}", P);
 
     lcgs::GSProjector projector;
-    projector.create(device);
+    projector.create(device, tile_size);
     lcgs::BufferFiller                           bf;
     luisa::parallel_primitive::DeviceScan<>      device_scan;
     luisa::parallel_primitive::DeviceRadixSort<> device_radix_sort;
@@ -182,8 +291,9 @@ int main(int argc, char** argv)
     auto d_rotq  = p_device->create_buffer<float>(P * 4);
     // payload
     auto d_sh      = p_device->create_buffer<float>(P * 16 * 3);
-    auto d_color   = p_device->create_buffer<float>(P * 3);
     auto d_opacity = p_device->create_buffer<float>(P);
+    // static scene, the 3d covariance is baked once after the upload
+    auto d_cov3d = p_device->create_buffer<float>(P * 6);
 
     // luisa::float3 pos = { 0.0f, -3.0f, 3.0f };
 
@@ -218,40 +328,37 @@ int main(int argc, char** argv)
              << d_rotq.view(0, P * 4).copy_from(data.rotq.data())
              << d_sh.view(0, P * 3 * 16).copy_from(data.feature.data())
              << d_opacity.view(0, P * 1).copy_from(data.opacity.data());
+    projector.precompute_cov3d(cmd_list, { P, d_pos, d_scale, d_rotq, 1.0f }, d_cov3d);
 
     auto* p_stream = &stream;
     stream << cmd_list.commit() << synchronize();
 
     luisa::Clock clk;
     clk.tic();
-    lcgs::GSTileSplatter tile_splatter;
-    tile_splatter.create(*p_device);
+    lcgs::GSFusedSplatter tile_splatter;
+    tile_splatter.create(*p_device, { .binning = binning, .sync_free = sync_free, .depth_bits = depth_bits, .pixels_per_thread = pixels_per_thread, .tile_size = tile_size, .temporal_order = temporal_order, .tile_split_size = tile_split_size, .persistent_blocks = persistent_blocks });
     tile_splatter.set_buffer_filler(&bf);
     tile_splatter.set_device_scan(&device_scan);
     tile_splatter.set_device_radix_sort(&device_radix_sort);
-    auto d_means_2d       = p_device->create_buffer<float>(P * 2);
-    auto d_depth_features = p_device->create_buffer<float>(P);
-    auto d_covs_2d        = p_device->create_buffer<float>(P * 3);
-    auto d_tiles_touched  = p_device->create_buffer<uint>(P);
-    auto d_points_offset  = p_device->create_buffer<uint>(P);
-    int  w                = resolution.x;
-    int  h                = resolution.y;
-    auto bx               = tile_splatter.m_blocks.x;
-    auto by               = tile_splatter.m_blocks.y;
-    auto TWH              = luisa::make_uint2(
+    int  w   = resolution.x;
+    int  h   = resolution.y;
+    auto bx  = tile_splatter.m_blocks.x;
+    auto by  = tile_splatter.m_blocks.y;
+    auto TWH = luisa::make_uint2(
         (unsigned int)((w + bx - 1u) / bx),
         (unsigned int)((h + by - 1u) / by)
     );
-    auto L = 20000000; // max num rendered
-
-    auto d_point_list_keys_unsorted = p_device->create_buffer<luisa::ulong>(L);
-    auto d_point_list_unsorted      = p_device->create_buffer<uint>(L);
-    auto d_point_list_keys          = p_device->create_buffer<luisa::ulong>(L);
-    auto d_point_list               = p_device->create_buffer<uint>(L);
-    auto d_ranges                   = p_device->create_buffer<uint>(TWH.x * TWH.y * 2);
-
-    auto d_img   = p_device->create_buffer<float>(w * h * 3);
-    auto d_radii = p_device->create_buffer<int>(P);
+    // transient buffers per frame in flight, frame i + 1 is recorded while frame i renders
+    lcgs::FrameContext frames{ device, num_frames, P, resolution, TWH };
+    // the preprocess (SH + projection) runs on its own stream when async, the splatting waits for it
+    luisa::unique_ptr<luisa::compute::Stream> compute_stream;
+    if (async_compute)
+    {
+        compute_stream = luisa::make_unique<luisa::compute::Stream>(device.create_stream(StreamTag::COMPUTE));
+    }
+    auto* p_preprocess_stream = async_compute ? compute_stream.get() : p_stream;
+    lcgs::FrameResources*          last_frame = nullptr;
+    lcgs::GSTileSplatterInputProxy last_input{};
 
     luisa::unique_ptr<lcgs::Display> display;
     if (should_display)
@@ -265,60 +372,87 @@ int main(int argc, char** argv)
     auto exp_i = 0;
     while ((display != nullptr && display->is_running()) || (display == nullptr && exp_i++ < exp_N))
     {
-        sh_processor.process(cmd_list, { P, 3, d_pos }, cam, d_sh, d_color, 3, 3);
-        projector.forward(cmd_list, { P, d_pos, d_scale, d_rotq, 1.0f }, { d_means_2d, d_covs_2d, d_depth_features }, cam);
-        (*p_stream) << cmd_list.commit();
-
-        lcgs::GSSplatForwardOutputProxy output{
-            .height     = h,
-            .width      = w,
-            .target_img = d_img,
-            .radii      = d_radii
-        };
+        auto& frame = frames.begin_frame(*p_preprocess_stream);
+        if (!fused)
+        {
+            projector.forward(cmd_list, { P, d_pos, d_scale, d_rotq, 1.0f, d_cov3d, 1.0f }, { frame.means_2d, frame.covs_2d, frame.depth_features, frame.visible_ids, frame.num_visible }, cam);
+            // colors of the culled gaussians are never read
+            sh_processor.process_visible(cmd_list, { P, 3, d_pos }, cam, d_sh, frame.color, frame.visible_ids, frame.num_visible, 3, 3);
+        }
+        else
+        {
+            sh_processor.process(cmd_list, { P, 3, d_pos }, cam, d_sh, frame.color, 3, 3);
+        }
+        (*p_preprocess_stream) << cmd_list.commit();
+        frames.hand_over(*p_preprocess_stream, *p_stream);
 
-        lcgs::GSTileSplatterAccelProxy accel{
-            .tiles_touched            = d_tiles_touched,
-            .point_offsets            = d_points_offset,
-            .point_list_keys_unsorted = d_point_list_keys_unsorted,
-            .point_list_unsorted      = d_point_list_unsorted,
-            .point_list_keys          = d_point_list_keys,
-            .point_list               = d_point_list,
-            .ranges                   = d_ranges
-        };
+        auto output = frame.output(w, h);
+        auto accel  = frame.accel();
 
         lcgs::GSTileSplatterInputProxy input{
             .num_gaussians    = P,
             .bg_color         = bg_color,
-            .means_2d         = d_means_2d,
-            .depth_features   = d_depth_features,
-            .conic            = d_covs_2d,
-            .color_features   = d_color,
+            .means_2d         = frame.means_2d,
+            .depth_features   = frame.depth_features,
+            .conic            = frame.covs_2d,
+            .color_features   = frame.color,
             .opacity_features = d_opacity,
+            .visible_ids      = frame.visible_ids,
+            .num_visible      = frame.num_visible,
+            .blend            = blend,
         };
 
-        int num_rendered = tile_splatter.forward(*p_device, *p_stream, accel, input, output);
+        int num_rendered = fused ?
+                               tile_splatter.forward(*p_device, *p_stream, accel, { P, d_pos, d_scale, d_rotq, 1.0f, d_cov3d, 1.0f }, cam, input, output) :
+                               tile_splatter.forward(*p_device, *p_stream, accel, input, output);
 
         if (display != nullptr)
         {
             exp_N++;
-            display->present(d_img);
+            display->present(frame.img);
         }
+        frames.end_frame(*p_stream);
+        last_frame = &frame;
+        last_input = input;
 
         // LUISA_INFO("num_rendered: {}", num_rendered);
     }
 
-    luisa::vector<float> h_img(w * h * 3);
-    luisa::vector<int>   h_radii(P);
+    luisa::vector<float> h_img(w * h * 3, 0.0f);
+    luisa::vector<int>   h_radii(P, 0);
 
-    (*p_stream) << d_img.copy_to(h_img.data())
-                << d_radii.copy_to(h_radii.data())
-                << luisa::compute::synchronize();
+    if (last_frame != nullptr)
+    {
+        (*p_stream) << last_frame->img.copy_to(h_img.data())
+                    << last_frame->radii.copy_to(h_radii.data());
+    }
+    (*p_stream) << luisa::compute::synchronize();
 
     auto exp_time = clk.toc();
     luisa::log_level_info();
     LUISA_INFO("exp time: {0} ms", exp_time);
     LUISA_INFO("fps: {0} with test N {1}", 1000.0f / (exp_time / exp_N), exp_N);
 
+    if (blend == lcgs::GSTileBlend::WeightedSum && last_frame != nullptr)
+    {
+        // the last frame again through the depth sorted blend, the reference of the weighted sum
+        auto d_ref_img        = device.create_buffer<float>(w * h * 3);
+        auto ref_output       = last_frame->output(w, h);
+        ref_output.target_img = d_ref_img.view();
+        last_input.blend      = lcgs::GSTileBlend::DepthSorted;
+        if (fused)
+        {
+            tile_splatter.forward(*p_device, *p_stream, last_frame->accel(), { P, d_pos, d_scale, d_rotq, 1.0f, d_cov3d, 1.0f }, cam, last_input, ref_output);
+        }
+        else
+        {
+            tile_splatter.forward(*p_device, *p_stream, last_frame->accel(), last_input, ref_output);
+        }
+        luisa::vector<float> h_ref(w * h * 3, 0.0f);
+        (*p_stream) << d_ref_img.copy_to(h_ref.data()) << luisa::compute::synchronize();
+        LUISA_INFO("weighted sum against the depth sorted blend: PSNR {:.2f} dB", lcgs::image_psnr(h_img.data(), h_ref.data(), h_img.size()));
+    }
+
     // 3 x H x W -> W x H x 3
     luisa::vector<uint8_t> h_img_rgb(w * h * 3); // Change to uint8_t for proper image format
     // Fill with red (255,0,0)
@@ -58,19 +58,20 @@ protected:
     template <size_t I, typename... Ts>
     using Kernel = luisa::compute::Kernel<I, Ts...>;
 
-    using Device      = luisa::compute::Device;
-    using CommandList = luisa::compute::CommandList;
-    using float2      = luisa::float2;
-    using float3      = luisa::float3;
-    using float4      = luisa::float4;
-    using float3x3    = luisa::float3x3;
-    using float4x4    = luisa::float4x4;
-    using uint        = luisa::uint;
-    using uint2       = luisa::uint2;
-    using uint3       = luisa::uint3;
-    using ulong       = luisa::ulong;
-    using Stream      = luisa::compute::Stream;
-    using Type        = luisa::compute::Type;
+    using Device                 = luisa::compute::Device;
+    using CommandList            = luisa::compute::CommandList;
+    using IndirectDispatchBuffer = luisa::compute::IndirectDispatchBuffer;
+    using float2                 = luisa::float2;
+    using float3                 = luisa::float3;
+    using float4                 = luisa::float4;
+    using float3x3               = luisa::float3x3;
+    using float4x4               = luisa::float4x4;
+    using uint                   = luisa::uint;
+    using uint2                  = luisa::uint2;
+    using uint3                  = luisa::uint3;
+    using ulong                  = luisa::ulong;
+    using Stream                 = luisa::compute::Stream;
+    using Type                   = luisa::compute::Type;
 };
 
 } // namespace lcgs
\ No newline at end of file
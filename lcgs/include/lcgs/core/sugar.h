@@ -54,6 +54,28 @@ inline void write_float4(luisa::compute::BufferVar<float>& buffer, luisa::comput
     buffer.write(4 * idx + 3, value.w);
 }
 
+// symmetric 3x3 packed as (xx, xy, xz, yy, yz, zz)
+inline luisa::compute::Float3x3 read_sym3x3(luisa::compute::BufferVar<float>& buffer, luisa::compute::Int idx) noexcept
+{
+    auto xx = buffer.read(6 * idx + 0);
+    auto xy = buffer.read(6 * idx + 1);
+    auto xz = buffer.read(6 * idx + 2);
+    auto yy = buffer.read(6 * idx + 3);
+    auto yz = buffer.read(6 * idx + 4);
+    auto zz = buffer.read(6 * idx + 5);
+    return make_float3x3(xx, xy, xz, xy, yy, yz, xz, yz, zz);
+}
+
+inline void write_sym3x3(luisa::compute::BufferVar<float>& buffer, luisa::compute::Int idx, luisa::compute::Float3x3 value) noexcept
+{
+    buffer.write(6 * idx + 0, value[0][0]);
+    buffer.write(6 * idx + 1, value[0][1]);
+    buffer.write(6 * idx + 2, value[0][2]);
+    buffer.write(6 * idx + 3, value[1][1]);
+    buffer.write(6 * idx + 4, value[1][2]);
+    buffer.write(6 * idx + 5, value[2][2]);
+}
+
 inline int block_aligned(int x, int block)
 {
     return (x / block + (x % block ? 1 : 0)) * block;
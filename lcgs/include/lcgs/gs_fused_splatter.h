@@ -0,0 +1,82 @@
+#pragma once
+/**
+ * @file gs_fused_splatter.h
+ * @brief The Gaussian Tile Splatter with a fused projection + tile allocation preprocess
+ */
+
+#include "lcgs/gs_tile_splatter.h"
+#include "lcgs/gs_projector.h"
+#include "lcgs/util/camera.h"
+
+namespace lcgs
+{
+
+// goes from the 3d gaussians to conic, pixel mean, radius and tiles_touched in one pass
+// GSProjector + GSTileSplatter stay the split path for debugging
+class LCGS_API GSFusedSplatter : public GSTileSplatter
+{
+public:
+    GSFusedSplatter()  = default;
+    ~GSFusedSplatter() = default;
+
+    // the split path, expects the 2d splats of a GSProjector in input
+    using GSTileSplatter::forward;
+    using GSTileSplatter::build;
+    // input.means_2d, conic and depth_features are written by the preprocess instead of read,
+    // culling happens in the preprocess so input.visible_ids is ignored
+    // a projection.cov3d is only read while its cov3d_scale_modifier matches, like in GSProjector
+    int forward(
+        Device&                   device,
+        Stream&                   stream,
+        GSTileSplatterAccelProxy  accel,
+        GSProjectorInputProxy     projection,
+        lcgs::Camera&             cam,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output
+    ) noexcept;
+    // the fused binning only, rasterize renders over it like over GSTileSplatter::build
+    int build(
+        Device&                   device,
+        Stream&                   stream,
+        GSTileSplatterAccelProxy  accel,
+        GSProjectorInputProxy     projection,
+        lcgs::Camera&             cam,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output
+    ) noexcept;
+
+    // same meaning as GSProjector::m_guard_band
+    float m_guard_band = 1.1f;
+
+protected:
+    void compile(Device& device) noexcept override;
+    void compile_preprocess_shader(Device& device) noexcept;
+
+    U<Shader<1, int,                // P
+             Buffer<float>,         // means_3d
+             Buffer<float>,         // scale_buffer
+             Buffer<float>,         // rotq_buffer
+             float,                 // scale_modifier
+             Buffer<float>,         // cov3d // 6 * P
+             bool,                  // use_cov3d
+             Buffer<float>,         // opacity_features // P
+             Buffer<float>,         // color_features // 3 * P
+             // output
+             Buffer<float>,         // means_2d // 2 * P, pixel space
+             Buffer<float>,         // depth_features // P
+             Buffer<float>,         // conic // 3 * P
+             Buffer<uint>,          // tiles_touched // P
+             Buffer<int>,           // radii // P
+             Buffer<GSSplatRecord>, // records // P
+             // PARAMS
+             float,                 // guard_band
+             float, float,          // tanfovx, tanfovy
+             float, float,          // focalx, focaly
+             float4x4,              // view_matrix
+             float4x4,              // proj_matrix
+             uint2, uint2           // resolution, grids
+             >>
+        shad_preprocess;
+};
+
+} // namespace lcgs
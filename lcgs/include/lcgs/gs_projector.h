@@ -19,12 +19,31 @@ struct GSProjectorInputProxy {
     luisa::compute::BufferView<float> scale;
     luisa::compute::BufferView<float> rotq;
     float                             scale_modifier;
+    // optional cov3d from GSProjector::precompute_cov3d, read instead of scale and rotq
+    luisa::compute::BufferView<float> cov3d; // 6 * P
+    // the scale modifier cov3d was baked with, a cov3d that does not match scale_modifier is not read
+    float cov3d_scale_modifier = 0.0f;
+
+    // whether the projection reads cov3d, warns when a baked one is skipped for its scale modifier
+    [[nodiscard]] bool use_cov3d() const noexcept
+    {
+        if (cov3d.size() == 0) { return false; }
+        if (cov3d_scale_modifier != scale_modifier)
+        {
+            LUISA_WARNING("cov3d was baked with scale modifier {} instead of {}, falling back to scale and rotq", cov3d_scale_modifier, scale_modifier);
+            return false;
+        }
+        return true;
+    }
 };
 
 struct GSProjectorOutputProxy {
-    luisa::compute::BufferView<float> means_2d;
-    luisa::compute::BufferView<float> covs_2d;
-    luisa::compute::BufferView<float> depth;
+    luisa::compute::BufferView<float>       means_2d;
+    luisa::compute::BufferView<float>       covs_2d;
+    luisa::compute::BufferView<float>       depth;
+    // optional, left empty no visible list is compacted and the splatter walks all P
+    luisa::compute::BufferView<luisa::uint> visible_ids; // P, ids of the gaussians inside the frustum
+    luisa::compute::BufferView<luisa::uint> num_visible; // 1
 };
 
 class LCGS_API GSProjector : public GSModule
@@ -32,7 +51,13 @@ class LCGS_API GSProjector : public GSModule
 public:
     GSProjector()  = default;
     ~GSProjector() = default;
-    void create(Device& device) noexcept;
+    // tile_size sets the block of the projection kernels, match it with the splatter
+    void create(Device& device, uint2 tile_size = { 16u, 16u }) noexcept;
+
+    // bakes scale_modifier * scale and rotq into the packed 3d covariance, run it again
+    // whenever the attributes or the scale modifier change, the inputs reading it carry
+    // input.scale_modifier as their cov3d_scale_modifier
+    void precompute_cov3d(CommandList& cmdlist, GSProjectorInputProxy input, BufferView<float> cov3d) noexcept;
 
     void forward(
         CommandList&           cmdlist,
@@ -42,14 +67,24 @@ public:
         bool                   use_focal = true
     ) noexcept;
 
+    // widens the culling frustum, splats are kept while their 3 sigma sphere touches it
+    float m_guard_band = 1.1f;
+
 protected:
-    uint2 m_blocks = { 16u, 16u };
-    void  compile(Device& device) noexcept;
-    void  compile_callables(Device& device) noexcept override;
-    void  compile_gs_project_shader(Device& device) noexcept;
+    void compile(Device& device) noexcept;
+    void compile_gs_project_shader(Device& device) noexcept;
+
+    // bound in place of the visible list when the output has none, never accessed
+    luisa::unique_ptr<Buffer<uint>> m_dummy_uint;
+
+    U<Shader<1, int,        // P
+             Buffer<float>, // scale_buffer
+             Buffer<float>, // rotq_buffer
+             float,         // scale_modifier
+             Buffer<float>  // cov3d // 6 * P
+             >>
+        shad_precompute_cov3d;
 
-    // callables
-    UCallable<float3(float3, float, float)> mp_cam_clamp;
     // shaers
     U<Shader<1, int,        // P
              Buffer<float>, // means_3d
@@ -61,6 +96,12 @@ protected:
              Buffer<float>, // means_2d // 2 * P
              Buffer<float>, // depth_features // P
              Buffer<float>, // conic // 3 * P
+             Buffer<uint>,  // visible_ids // P
+             Buffer<uint>,  // num_visible // 1
+             bool,          // compact
+             float,         // guard_band
+             Buffer<float>, // cov3d // 6 * P
+             bool,          // use_cov3d
              // PARAMS
              float, float, // tanfov x, tanfov y
              float4x4,     // view_matrix
@@ -78,6 +119,12 @@ protected:
              Buffer<float>, // means_2d // 2 * P
              Buffer<float>, // depth_features // P
              Buffer<float>, // conic // 3 * P
+             Buffer<uint>,  // visible_ids // P
+             Buffer<uint>,  // num_visible // 1
+             bool,          // compact
+             float,         // guard_band
+             Buffer<float>, // cov3d // 6 * P
+             bool,          // use_cov3d
              // PARAMS
              float, float, // tanfov x, tanfov y
              float, float, // focalx, focaly
@@ -10,13 +10,76 @@
 #include "lcgs/module.h"
 #include "lcgs/proxy.h"
 #include "lcgs/util/buffer_filler.h"
+#include "lcgs/util/tile_key.h"
+#include "lcgs/util/transient_planner.h"
 #include <lcpp/device/device_scan.h>
 #include <lcpp/device/device_radix_sort.h>
 #include "proxy.h"
+#include <array>
+#include <functional>
 
 namespace lcgs
 {
 
+enum class GSTileBinning : luisa::uint
+{
+    RadixSort    = 0, // global radix sort of (tile | depth) keys
+    CountingSort = 1  // per-tile counting sort of ids, then a depth sort inside each tile
+};
+
+struct GSTileSplatterConfig {
+    GSTileBinning binning = GSTileBinning::RadixSort;
+    // enqueue the whole pipeline in one submission without reading num_rendered back,
+    // the sort is sized by the last observed num_rendered, which is one frame late
+    bool        sync_free          = false;
+    float       sync_free_headroom = 1.5f;       // sort bound = headroom * last num_rendered
+    luisa::uint sync_free_min_size = 1u << 16u; // lower clamp of the sort bound
+    // bits of view depth kept in the sort key, 32 keeps the full float, fewer keep a log level over
+    // [depth_near, depth_far], the key shrinks to 32 bit (half the radix passes) when tile bits + depth bits fit
+    luisa::uint depth_bits = 32u;
+    float       depth_near = 0.2f; // the near culling plane of the projection
+    float       depth_far  = 1000.0f;
+    // pixel footprint shaded by one render thread, e.g. 2x1, 2x2 or 4x1, must divide the tile
+    luisa::uint2 pixels_per_thread = { 1u, 1u };
+    // pixels of a tile, e.g. 8x8, 16x8, 16x16 or 32x8
+    luisa::uint2 tile_size = { 16u, 16u };
+    // radix binning only: keep the depth order of the last frame, repair it with windowed sorts
+    // and sort the keys by tile alone, a stable sort then leaves every tile in depth order
+    bool        temporal_order        = false;
+    luisa::uint temporal_fixup_passes = 2u;    // windowed sorts per frame, every other one shifted by half a window
+    float       temporal_max_unsorted = 1e-4f; // fraction of adjacent inversions left over that re-seeds the order
+    // capacity of the point lists, grown to headroom * num_rendered when a build needs more
+    // and shrunk once the need stayed below shrink_ratio of the capacity for shrink_builds builds
+    float       point_list_headroom      = 1.25f;
+    luisa::uint point_list_min_size      = 1u << 16u;
+    float       point_list_shrink_ratio  = 0.25f;
+    luisa::uint point_list_shrink_builds = 64u;
+    // sync-free: a build whose keys overflowed its bound is enqueued again once the count is known,
+    // otherwise the keys past the bound are dropped for that frame
+    bool point_list_rerun_on_overflow = true;
+    // GSTileBlend::WeightedSum builds: a splat at view depth z weighs exp(-falloff * z)
+    // against the others of its pixel, larger values let the near splats occlude more
+    float weighted_sum_depth_falloff = 1.0f;
+    // heavy tiles, those with a list longer than tile_split_factor x the mean of the non-empty tiles
+    // and than 2 x tile_split_size, are blended by up to tile_split_max_chunks blocks of about
+    // tile_split_size splats each and composited in a second pass, 0 keeps one block per tile
+    luisa::uint tile_split_size         = 0u;
+    float       tile_split_factor       = 4.0f;
+    luisa::uint tile_split_max_chunks   = 32u;
+    luisa::uint tile_split_max_partials = 2048u; // chunks of all split tiles in one build, tiles past it stay whole
+    // render blocks launched at most, each pulls work items off the heaviest-first queue until it is drained,
+    // 0 launches one block per item
+    luisa::uint persistent_blocks = 0u;
+};
+
+// the slots walked by the per-gaussian stages
+struct GSVisibleSet {
+    luisa::compute::BufferView<luisa::uint> ids;   // slot -> gaussian id when compacted
+    luisa::compute::BufferView<luisa::uint> count; // device count of the valid slots
+    bool                                    compacted = false;
+    luisa::uint                             bound     = 0u; // host upper bound of count, sizes the dispatches
+};
+
 class LCGS_API GSTileSplatter : public GSModule
 {
 public:
@@ -24,7 +87,9 @@ public:
     GSTileSplatter()          = default;
     virtual ~GSTileSplatter() = default;
 
-    virtual void create(Device& device) noexcept;
+    virtual void create(Device& device, GSTileSplatterConfig config = {}) noexcept;
+    // build + rasterize of the input colors over input.bg_color
+    // returns num_rendered, in sync-free mode this is the count of the previous frame
     virtual int  forward(
          Device&                   device,
          Stream&                   stream,
@@ -33,6 +98,25 @@ public:
          GSSplatForwardOutputProxy output,
          bool                      use_focal = true
      ) noexcept;
+    // bins the splats of input into accel.records, accel.ranges and the point lists and writes output.radii,
+    // output.target_img is left untouched, returns num_rendered like forward
+    virtual int build(
+        Device&                   device,
+        Stream&                   stream,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        bool                      use_focal = true
+    ) noexcept;
+    // blends payload over the last build into output.target_img,
+    // runs any number of times per build as long as accel is left alone
+    void rasterize(
+        Device&                    device,
+        Stream&                    stream,
+        GSTileSplatterAccelProxy   accel,
+        GSTileSplatterPayloadProxy payload,
+        GSSplatForwardOutputProxy  output
+    ) noexcept;
 
     BufferFiller* mp_buffer_filler;
     void          set_buffer_filler(BufferFiller* buffer_filler) noexcept { mp_buffer_filler = buffer_filler; }
@@ -42,67 +126,580 @@ public:
     void                                          set_device_scan(luisa::parallel_primitive::DeviceScan<>* scan) noexcept { mp_device_scan = scan; }
     void                                          set_device_radix_sort(luisa::parallel_primitive::DeviceRadixSort<>* sort) noexcept { mp_device_radix_sort = sort; }
 
-    // Temp buffer management for parallel primitives
-    void ensure_scan_temp_buffer(Device& device, size_t num_items);
-    void ensure_radix_sort_temp_buffer(Device& device, size_t num_items);
+    // places the per-build scratch (temp storage of the parallel primitives, point lists, tile bins)
+    // in the transient arena, re-planned when one of the sizes changes, which waits for stream first
+    // returns whether it was re-planned, the contents of the old arena are gone then
+    bool ensure_transient_arena(Device& device, Stream& stream, size_t num_gaussians, size_t num_tiles);
+    void ensure_temporal_buffers(Device& device, size_t num_gaussians);
+    void ensure_active_tile_buffers(Device& device, size_t num_tiles);
+    // partial results of the split tiles, tile_split_max_partials x (channels + partial_fields) x tile pixels floats
+    void ensure_partial_buffer(Device& device, Stream& stream, uint channels);
+    [[nodiscard]] size_t                  point_list_capacity() const noexcept { return m_point_list_capacity; }
+    [[nodiscard]] const TransientPlanner& transient_plan() const noexcept { return m_transient_plan; }
+    // drop the kept depth order, the next frame sorts depth from scratch, e.g. after a camera cut
+    void reset_temporal_order() noexcept { m_temporal_seeded = false; }
+
+protected:
+    // the allocate stage of one build, the state of the call it belongs to is captured by enqueue
+    struct AllocateStage {
+        std::function<void(CommandList&, GSTileSplatterAccelProxy, GSTileSplatterInputProxy, GSSplatForwardOutputProxy, GSVisibleSet, uint2)> enqueue;
+        // whether input.depth_features holds this frame's depth before the stage runs, which the temporal depth order needs
+        bool depth_ready = true;
+    };
+    // build with its allocate stage passed in, build runs it with enqueue_allocate,
+    // modules that produce the 2d splats themselves pass their own
+    int build_staged(
+        Device&                   device,
+        Stream&                   stream,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        const AllocateStage&      allocate
+    ) noexcept;
 
 private:
-    // Temp buffers for device scan and radix sort
-    // Using uint as the element type (as required by the API)
-    luisa::unique_ptr<Buffer<uint>> m_scan_temp_buffer;
-    luisa::unique_ptr<Buffer<uint>> m_radix_sort_temp_buffer;
-    size_t                          m_scan_temp_buffer_size = 0;       // in uint count
-    size_t                          m_radix_sort_temp_buffer_size = 0; // in uint count
+    // per-tile histogram and its inclusive scan, the total ends up in the last tile offset
+    void enqueue_bin_count(
+        Device&                   device,
+        CommandList&              cmdlist,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        GSVisibleSet              visible,
+        uint2                     grids
+    ) noexcept;
+    // ranges, scatter of ids into tile buckets and, with depth_sort, the per-tile depth sort,
+    // max_count bounds num_rendered and sets the number of merge rounds
+    void enqueue_bin_scatter(
+        Device&                   device,
+        CommandList&              cmdlist,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        GSVisibleSet              visible,
+        uint2                     grids,
+        size_t                    max_count,
+        bool                      depth_sort
+    ) noexcept;
+
+    // copy_with_keys -> sort -> get_ranges over the first count keys
+    template <typename KeyT>
+    void enqueue_sort_stages(
+        Device&                   device,
+        CommandList&              cmdlist,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        GSVisibleSet              visible,
+        uint2                     grids,
+        TileKeyLayout             layout,
+        size_t                    count,
+        bool                      pad_keys
+    ) noexcept;
+
+    // host copies of the device counters of one build, filled by async copies and only read
+    // once the readback event reached fence, a slot is reused readback_slots builds later
+    struct ReadbackSlot {
+        uint     num_rendered     = 0u;
+        uint     num_visible      = 0u;
+        uint     visible_bound    = 0u; // sync-free: slots walked by the build, num_visible past it overflowed
+        size_t   rendered_bound   = 0u; // sync-free: point list entries kept by the build
+        uint     order_inversions = 0u; // temporal: left by the repair
+        uint64_t fence            = 0u; // 0 until the slot is first used
+    };
+    static constexpr uint readback_slots = 4u;
+    // takes the slot of a new build, waiting for the build that used it last
+    ReadbackSlot& next_readback() noexcept;
+    // the newest build whose copies have landed, nullptr before the first one did
+    [[nodiscard]] const ReadbackSlot* last_readback() const noexcept;
+
+    // repairs (or re-seeds) the kept depth order of all gaussians and filters it
+    // down to the slots of visible, the returned set walks them front to back
+    GSVisibleSet enqueue_temporal_order(
+        Device&                  device,
+        CommandList&             cmdlist,
+        GSTileSplatterInputProxy input,
+        GSVisibleSet             visible,
+        ReadbackSlot&            readback
+    ) noexcept;
+    // the next frame re-seeds when the last repair left too many inversions
+    void check_temporal_order(size_t num_gaussians, const ReadbackSlot* last) noexcept;
+
+    // capacity of the point lists for a build of num_rendered pairs, the current one while it fits
+    // and was not oversized for point_list_shrink_builds builds in a row
+    size_t plan_point_list_capacity(size_t num_rendered) noexcept;
+
+    // a whole resource of the transient arena, a size that is no multiple of a uint is rounded up,
+    // the offsets and the arena are aligned to at least a uint so the tail stays in the gap behind it
+    template <typename T>
+    [[nodiscard]] BufferView<T> transient_view(uint32_t id) const noexcept
+    {
+        auto offset = m_transient_plan.offset(id) / sizeof(uint);
+        auto size   = (m_transient_plan.bytes(id) + sizeof(uint) - 1u) / sizeof(uint);
+        return m_transient_arena->view(offset, size).template as<T>();
+    }
+
+    // builds the work list of the render kernels from the ranges, one item per non-empty tile or per chunk
+    // of a heavy tile, orders it into the render queue by list length and writes the indirect dispatches
+    // of the render and the composite kernels
+    void enqueue_active_tiles(
+        Device&                  device,
+        CommandList&             cmdlist,
+        GSTileSplatterAccelProxy accel,
+        uint2                    grids
+    ) noexcept;
+
+    // the input's visible list, or all gaussians when it has none
+    // in sync mode this reads num_visible back into readback, in sync-free mode the bound comes from last
+    GSVisibleSet visible_set(
+        Stream&                  stream,
+        GSTileSplatterAccelProxy accel,
+        GSTileSplatterInputProxy input,
+        ReadbackSlot&            readback,
+        const ReadbackSlot*      last
+    ) noexcept;
+
+    // rerun: the second pass of a build that overflowed, its overflow was already reported
+    int build_sync_free(
+        Device&                   device,
+        Stream&                   stream,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        const AllocateStage&      allocate,
+        bool                      rerun = false
+    ) noexcept;
+
+    GSTileSplatterConfig m_config;
+    // bound in place of optional uint views that are never accessed, so no view of a dispatch aliases another
+    luisa::unique_ptr<Buffer<uint>> m_dummy_uint;
+    std::array<ReadbackSlot, readback_slots> m_readbacks;
+    luisa::unique_ptr<TimelineEvent>          m_readback_event;
+    uint64_t                                  m_readback_fence     = 0u; // fence of the newest slot
+    size_t                                    m_sync_free_capacity = 0;  // largest sort bound enqueued so far
+    // binning of the last build, rasterize renders against it
+    uint2       m_built_resolution = { 0u, 0u };
+    uint2       m_built_grids      = { 0u, 0u };
+    int         m_built_gaussians  = 0;
+    int         m_built_count      = 0; // bound of num_rendered
+    GSTileBlend m_built_blend      = GSTileBlend::DepthSorted;
+
+    // temporal depth order, 3 x P uints kept across builds, its per-build scratch lives in the arena
+    // order/keys: rank -> gaussian and its depth bits
+    // scratch: sort ping-pong, then per-gaussian visible flags and the ordered slots walked by the build
+    luisa::unique_ptr<Buffer<uint>> m_depth_order;
+    luisa::unique_ptr<Buffer<uint>> m_order_keys;
+    luisa::unique_ptr<Buffer<uint>> m_order_scratch;
+    luisa::unique_ptr<Buffer<uint>> m_order_stats; // adjacent inversions, number of ordered slots
+    bool                            m_temporal_seeded  = false;
+    size_t                          m_point_list_capacity    = 0;
+    uint                            m_point_list_idle_builds = 0u; // builds in a row below the shrink ratio
+
+    // per-build scratch aliased in one arena by lifetime, the stages are listed in transient.cpp
+    struct TransientIds {
+        uint32_t scan_temp           = TransientPlanner::invalid_id;
+        uint32_t order_sort_temp     = TransientPlanner::invalid_id; // temporal: depth sort of all gaussians
+        uint32_t order_scratch_keys  = TransientPlanner::invalid_id; // temporal: sort ping-pong, then rank flags
+        uint32_t order_offsets       = TransientPlanner::invalid_id; // temporal: scan of the rank flags
+        uint32_t tile_counts         = TransientPlanner::invalid_id; // tile binning: per-tile histogram
+        uint32_t tile_offsets        = TransientPlanner::invalid_id; // tile binning: its inclusive scan
+        uint32_t keys_unsorted       = TransientPlanner::invalid_id; // radix sort: ulong x capacity
+        uint32_t point_list_unsorted = TransientPlanner::invalid_id; // sort input, or the counting sort merge scratch
+        uint32_t sort_temp           = TransientPlanner::invalid_id; // radix sort: temp storage of capacity keys
+        uint32_t keys                = TransientPlanner::invalid_id; // radix sort: ulong x capacity
+        uint32_t point_list          = TransientPlanner::invalid_id; // read by every rasterize of the build
+    };
+    luisa::unique_ptr<Buffer<uint>> m_transient_arena;
+    TransientPlanner                m_transient_plan;
+    TransientIds                    m_transients;
+    size_t                          m_planned_gaussians = 0;
+    size_t                          m_planned_tiles     = 0;
+    size_t                          m_planned_capacity  = 0;
+    // work list of the last build, (tile, chunk) per item, as built and in queue order
+    luisa::unique_ptr<Buffer<uint>>           m_work_unordered;
+    luisa::unique_ptr<Buffer<uint>>           m_work_items;
+    luisa::unique_ptr<Buffer<uint>>           m_work_buckets; // items per log2 of the list length, then their offsets
+    // items, split tiles, reserved partial slots, non-empty tiles, splats of the non-empty tiles, queue head,
+    // render blocks that pull from the queue
+    luisa::unique_ptr<Buffer<uint>>           m_work_counts;
+    luisa::unique_ptr<Buffer<uint>>           m_tile_splits; // per tile: first partial slot (~0u when whole) and chunk count
+    luisa::unique_ptr<Buffer<uint>>           m_split_tiles; // tiles blended in chunks
+    luisa::unique_ptr<Buffer<float>>          m_partials;
+    luisa::unique_ptr<IndirectDispatchBuffer> m_render_args;    // one kernel, grids.x items per row of blocks
+    luisa::unique_ptr<IndirectDispatchBuffer> m_composite_args; // one kernel, one block per split tile
+    size_t                                    m_work_list_tiles = 0;
 
 protected:
     virtual void compile(Device& device) noexcept;
     virtual void compile_forward_shader(Device& device) noexcept;
     virtual void compile_impl_shader(Device& device) noexcept;
+    virtual void compile_binning_shader(Device& device) noexcept;
+    virtual void compile_temporal_shader(Device& device) noexcept;
+    virtual void compile_active_tile_shader(Device& device) noexcept;
 
-    U<Shader<1, int,        // P
-             uint2, uint2,  // resolution, grids
-             Buffer<float>, // depth_features // P
-             Buffer<float>, // means_2d // 2 * P
-             Buffer<float>, // covs_2d // 3 * P
-             Buffer<uint>,  // tiles_touched // P
-             Buffer<int>,   // radii // P
-             bool           // use_focal
+    // allocate_tiles over the visible slots, the allocate stage of build
+    void enqueue_allocate(
+        CommandList&              cmdlist,
+        GSTileSplatterAccelProxy  accel,
+        GSTileSplatterInputProxy  input,
+        GSSplatForwardOutputProxy output,
+        GSVisibleSet              visible,
+        uint2                     grids,
+        bool                      use_focal
+    ) noexcept;
+
+    // pixel-space mean and 2d cov (before the low-pass) -> conic, radius and number of covered tiles
+    // radius stays 0 for splats that never pass the alpha cut
+    UCallable<void(float2, float3, float, uint2, float3&, int&, uint&)> mp_splat_footprint;
+
+    U<Shader<1, int,                // P
+             uint2, uint2,          // resolution, grids
+             Buffer<float>,         // depth_features // P
+             Buffer<float>,         // means_2d // 2 * P
+             Buffer<float>,         // covs_2d // 3 * P
+             Buffer<float>,         // opacity_features // P
+             Buffer<float>,         // color_features // 3 * P
+             Buffer<uint>,          // tiles_touched // P
+             Buffer<int>,           // radii // P
+             Buffer<GSSplatRecord>, // records // P
+             Buffer<uint>,          // visible_ids // P
+             Buffer<uint>,          // num_visible // 1
+             bool,                  // compacted
+             bool                   // use_focal
              >>
         shad_allocate_tiles;
 
+    // output slots expanded by one thread of copy_with_keys
+    static constexpr uint key_expand_chunk = 32u;
+
+    template <typename KeyT>
+    using CopyWithKeysShader = Shader<1, int,        // P
+                                      Buffer<float>, // means_2d
+                                      Buffer<float>, // conic
+                                      Buffer<float>, // opacity
+                                      Buffer<uint>,  // offsets
+                                      Buffer<int>,   // radii
+                                      Buffer<float>, // depth
+                                      Buffer<KeyT>,  // keys_unsorted
+                                      Buffer<uint>,  // values_unsorted
+                                      uint2, uint2,  // blocks & grids
+                                      uint,          // capacity of keys/values
+                                      uint,          // depth_bits
+                                      float, float,  // depth_near, depth_scale
+                                      Buffer<uint>,  // visible_ids
+                                      bool           // compacted
+                                      >;
+    template <typename KeyT>
+    using GetRangesShader = Shader<1, int,       // num_rendered
+                                   Buffer<KeyT>, // point_list_keys
+                                   Buffer<uint>, // ranges
+                                   uint          // depth_bits
+                                   >;
+    template <typename KeyT>
+    void compile_key_shaders(Device& device, U<CopyWithKeysShader<KeyT>>& copy_with_keys, U<GetRangesShader<KeyT>>& get_ranges) noexcept;
+
+    // counting sort binning
+    // ids of a tile are depth sorted in shared memory chunks, longer tiles merge their chunks in rounds
+    static constexpr uint bin_sort_block = 256u;
+    static constexpr uint bin_sort_chunk = 2048u;
+    // ascending bitonic sort of the first n2 (a power of two) shared keys and ids by one bin_sort_block block
+    void block_bitonic_sort(SmemTypePtr<uint> keys, SmemTypePtr<uint> ids, luisa::compute::UInt n2) noexcept;
+
     U<Shader<1, int,        // P
              Buffer<float>, // means_2d
-             Buffer<uint>,  // offsets
+             Buffer<float>, // conic
+             Buffer<float>, // opacity
              Buffer<int>,   // radii
-             Buffer<float>, // depth
-             Buffer<ulong>, // keys_unsorted
-             Buffer<uint>,  // values_unsorted
-             uint2, uint2   // blocks & grids
+             Buffer<uint>,  // tile_counts
+             uint2, uint2,  // blocks & grids
+             Buffer<uint>,  // visible_ids
+             Buffer<uint>,  // num_visible
+             bool           // compacted
+             >>
+        shad_bin_count;
+
+    U<Shader<1, int,       // num_tiles
+             Buffer<uint>, // tile_counts
+             Buffer<uint>, // tile_offsets
+             Buffer<uint>, // ranges
+             uint          // capacity of point_list
+             >>
+        shad_bin_ranges;
+
+    U<Shader<1, int,        // P
+             Buffer<float>, // means_2d
+             Buffer<float>, // conic
+             Buffer<float>, // opacity
+             Buffer<int>,   // radii
+             Buffer<uint>,  // tile_counts
+             Buffer<uint>,  // tile_offsets
+             Buffer<uint>,  // point_list
+             uint2, uint2,  // blocks & grids
+             uint,          // capacity of point_list
+             Buffer<uint>,  // visible_ids
+             Buffer<uint>,  // num_visible
+             bool           // compacted
+             >>
+        shad_bin_scatter;
+
+    U<Shader<1, Buffer<uint>, // ranges
+             Buffer<uint>,    // point_list
+             Buffer<float>    // depth_features
+             >>
+        shad_sort_tile_chunks;
+
+    U<Shader<1, Buffer<uint>, // ranges
+             Buffer<uint>,    // src
+             Buffer<uint>,    // dst
+             Buffer<float>,   // depth_features
+             uint             // run length
              >>
-        shad_copy_with_keys;
+        shad_merge_tile_runs;
 
-    U<Shader<1, int,        // num_rendered
-             Buffer<ulong>, // point_list_keys
-             Buffer<uint>   // ranges
+    U<Shader<1, Buffer<uint>, // ranges
+             Buffer<uint>,    // scratch
+             Buffer<uint>,    // point_list
+             uint             // number of merge rounds
              >>
-        shad_get_ranges;
+        shad_resolve_tile_runs;
 
+    // temporal depth order
+    U<Shader<1, int,      // P
+             Buffer<uint> // order
+             >>
+        shad_order_seed;
+
+    U<Shader<1, int,        // P
+             Buffer<uint>,  // order
+             Buffer<float>, // depth_features
+             Buffer<uint>   // keys
+             >>
+        shad_order_gather;
+
+    // one block sorts a window of bin_sort_chunk ranks
+    U<Shader<1, int,       // P
+             Buffer<uint>, // order
+             Buffer<uint>, // keys
+             uint          // offset of the first window
+             >>
+        shad_order_fixup;
+
+    U<Shader<1, int,       // P
+             Buffer<uint>, // keys
+             Buffer<uint>  // stats
+             >>
+        shad_order_count_inversions;
+
+    U<Shader<1, int,       // slots
+             Buffer<uint>, // visible_ids
+             Buffer<uint>, // num_visible
+             Buffer<uint>  // flags, per gaussian
+             >>
+        shad_order_mark;
+
+    U<Shader<1, int,       // P
+             Buffer<uint>, // order
+             Buffer<uint>, // flags, per gaussian
+             Buffer<uint>, // rank_flags
+             bool          // compacted
+             >>
+        shad_order_rank_flags;
+
+    U<Shader<1, int,       // P
+             Buffer<uint>, // order
+             Buffer<uint>, // rank_flags
+             Buffer<uint>, // offsets
+             Buffer<uint>, // ordered_ids
+             Buffer<uint>  // stats
+             >>
+        shad_order_compact;
+
+    // work list
+    U<Shader<1, int,       // num_tiles
+             Buffer<uint>, // ranges
+             Buffer<uint>  // work_counts
+             >>
+        shad_tile_stats;
+
+    U<Shader<1, int,       // num_tiles
+             Buffer<uint>, // ranges
+             Buffer<uint>, // work_items
+             Buffer<uint>, // work_counts
+             Buffer<uint>, // tile_splits
+             Buffer<uint>, // split_tiles
+             uint,         // split size, 0 for none
+             float,        // split factor
+             uint,         // max chunks per tile
+             uint          // max partials
+             >>
+        shad_build_work_list;
+
+    // heaviest-first order of the work list, a counting sort by the leading zeros of the list length
+    // is heaviest first up to a factor of two, which is what the queue needs to start the long tiles early
+    static constexpr uint work_buckets = 32u;
+    U<Shader<1, int,       // max items
+             Buffer<uint>, // ranges
+             Buffer<uint>, // work_unordered
+             Buffer<uint>, // work_counts
+             Buffer<uint>, // tile_splits
+             Buffer<uint>  // work_buckets
+             >>
+        shad_work_histogram;
+
+    U<Shader<1, Buffer<uint> // work_buckets
+             >>
+        shad_work_bucket_offsets;
+
+    U<Shader<1, int,       // max items
+             Buffer<uint>, // ranges
+             Buffer<uint>, // work_unordered
+             Buffer<uint>, // work_counts
+             Buffer<uint>, // tile_splits
+             Buffer<uint>, // work_buckets
+             Buffer<uint>  // work_items
+             >>
+        shad_order_work_queue;
+
+    U<Shader<1, Buffer<uint>,         // work_counts
+             uint2, uint2,            // blocks of a tile & grids
+             uint,                    // persistent blocks, 0 for one per item
+             IndirectDispatchBuffer,  // render_args
+             IndirectDispatchBuffer   // composite_args
+             >>
+        shad_active_tile_args;
+
+    // one thread per pixel of a split tile, blends its chunks front to back
     U<Shader<2,
-             uint2,         // resolution
-             int, int,      // P, L // for debug
-             Buffer<float>, // target img
-             // params
-             uint2,  // grids
-             float3, // bg_color
-             // input buffers
+             uint2, uint2,  // resolution, grids
              Buffer<uint>,  // ranges
-             Buffer<uint>,  // point_list
-             Buffer<float>, // means_2d, P x 2
-             Buffer<float>, // conic, P x 3
-             Buffer<float>, // opacity_features, P
-             Buffer<float>  // color_features, P * 3
+             Buffer<uint>,  // work_counts
+             Buffer<uint>,  // tile_splits
+             Buffer<uint>,  // split_tiles
+             Buffer<float>, // partials
+             Buffer<float>, // target img, channels x H x W
+             uint,          // channels
+             float3,        // bg_color
+             bool,          // weighted_sum
+             Buffer<float>, // alpha
+             Buffer<float>, // depth
+             Buffer<float>, // median_depth
+             Buffer<uint>,  // n_contrib
+             uint           // aux_mask
              >>
-        m_forward_render_shader;
+        shad_composite_split_tiles;
+
+    // one thread per pixel, writes the background and the empty aux values of the tiles without splats
+    U<Shader<2,
+             uint2, uint2,  // resolution, grids
+             Buffer<uint>,  // ranges
+             Buffer<float>, // target img, channels x H x W
+             uint,          // channels
+             float3,        // bg_color
+             Buffer<float>, // alpha
+             Buffer<float>, // depth
+             Buffer<float>, // median_depth
+             Buffer<uint>,  // n_contrib
+             uint           // aux_mask
+             >>
+        shad_fill_empty_tiles;
+
+    U<CopyWithKeysShader<ulong>> shad_copy_with_keys;
+    U<CopyWithKeysShader<uint>>  shad_copy_with_keys_32;
+    U<GetRangesShader<ulong>>    shad_get_ranges;
+    U<GetRangesShader<uint>>     shad_get_ranges_32;
+
+    // shared memory of one render block, the staged means, conics and payloads of a round
+    static constexpr uint render_shared_bytes = 40960u;
+    // aux outputs of the render kernels, bits of aux_mask
+    static constexpr uint aux_alpha        = 1u << 0u;
+    static constexpr uint aux_depth        = 1u << 1u;
+    static constexpr uint aux_median_depth = 1u << 2u;
+    static constexpr uint aux_n_contrib    = 1u << 3u;
+    // a split chunk does not know the transmittance in front of it, so besides its median it keeps the depths
+    // where its own T first dropped below 1 - s / (2 x median_steps), the composite takes the one nearest the
+    // crossing of the running T
+    static constexpr uint median_steps = 4u;
+    // fields of a partial result after the channels: T, D, W, median, last contributor and the median steps
+    static constexpr uint partial_fields = 5u + median_steps;
+    // blend loop of the render kernels, blocks pull work items off the queue and leave once it is drained
+    // the chunks of a split tile write their partial results, see shad_composite_split_tiles
+    // load_payload(coll_id, record, payload) fills the channels floats of a splat,
+    // store_pixel(pix_id, T, C) writes a finished pixel, the aux outputs of aux_mask are written here
+    // weighted_sum blends the whole tile list in any order, see compile_forward_shader
+    template <typename LoadPayload, typename StorePixel>
+    void blend_tile(
+        luisa::compute::UInt2                     resolution,
+        luisa::compute::UInt2                     grids,
+        luisa::compute::BufferVar<uint>&          ranges,
+        luisa::compute::BufferVar<uint>&          work_items,
+        luisa::compute::BufferVar<uint>&          work_counts,
+        luisa::compute::BufferVar<uint>&          tile_splits,
+        luisa::compute::BufferVar<float>&         partials,
+        luisa::compute::BufferVar<uint>&          point_list,
+        luisa::compute::BufferVar<GSSplatRecord>& records,
+        luisa::compute::BufferVar<float>&         alpha,
+        luisa::compute::BufferVar<float>&         depth,
+        luisa::compute::BufferVar<float>&         median_depth,
+        luisa::compute::BufferVar<uint>&          n_contrib,
+        luisa::compute::UInt                      aux_mask,
+        uint                                      channels,
+        bool                                      weighted_sum,
+        luisa::compute::Float                     depth_falloff,
+        LoadPayload&&                             load_payload,
+        StorePixel&&                              store_pixel
+    ) noexcept;
+    void compile_feature_render_shader(Device& device, size_t slot, bool weighted_sum) noexcept;
+
+    using RecordRenderShader = Shader<2,
+                                      uint2,         // resolution
+                                      int, int,      // P, L // for debug
+                                      Buffer<float>, // target img
+                                      // params
+                                      uint2,  // grids
+                                      float3, // bg_color
+                                      // input buffers
+                                      Buffer<uint>,          // ranges
+                                      Buffer<uint>,          // work_items
+                                      Buffer<uint>,          // work_counts
+                                      Buffer<uint>,          // tile_splits
+                                      Buffer<float>,         // partials
+                                      Buffer<uint>,          // point_list
+                                      Buffer<GSSplatRecord>, // records, P
+                                      // aux outputs, H x W
+                                      Buffer<float>, // alpha
+                                      Buffer<float>, // depth
+                                      Buffer<float>, // median_depth
+                                      Buffer<uint>,  // n_contrib
+                                      uint,          // aux_mask
+                                      float          // weighted sum depth falloff
+                                      >;
+    U<RecordRenderShader> m_forward_render_shader;
+    U<RecordRenderShader> m_weighted_sum_render_shader;
+
+    // payload widths with a specialized render kernel, compiled on first use
+    static constexpr std::array<uint, 6> feature_channels = { 1u, 3u, 4u, 8u, 16u, 32u };
+    using FeatureRenderShader = Shader<2,
+                                       uint2,                 // resolution
+                                       int, int,              // P, L // for debug
+                                       Buffer<float>,         // target img, channels x H x W
+                                       uint2,                 // grids
+                                       float3,                // bg_color
+                                       Buffer<uint>,          // ranges
+                                       Buffer<uint>,          // work_items
+                                       Buffer<uint>,          // work_counts
+                                       Buffer<uint>,          // tile_splits
+                                       Buffer<float>,         // partials
+                                       Buffer<uint>,          // point_list
+                                       Buffer<GSSplatRecord>, // records, P
+                                       Buffer<float>,         // features, P x channels
+                                       Buffer<float>,         // alpha
+                                       Buffer<float>,         // depth
+                                       Buffer<float>,         // median_depth
+                                       Buffer<uint>,          // n_contrib
+                                       uint,                  // aux_mask
+                                       float                  // weighted sum depth falloff
+                                       >;
+    std::array<U<FeatureRenderShader>, feature_channels.size()> m_feature_render_shaders;
+    std::array<U<FeatureRenderShader>, feature_channels.size()> m_feature_weighted_sum_shaders;
 };
 
 } // namespace lcgs
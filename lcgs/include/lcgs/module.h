@@ -15,10 +15,20 @@ class GSModule : public LuisaModule
 {
 public:
     uint2 m_blocks = { 16u, 16u };
+    // one thread per pixel of a tile has to fit in a block
+    static constexpr uint max_tile_threads = 1024u;
 
 protected:
     UCallable<float(float, uint)> mp_ndc2pix;
     UCallable<void(float2, int, uint2&, uint2&, uint2, uint2)> mp_get_rect;
+    // largest q = d^T conic d at which a splat of this opacity still passes the 1/255 alpha cut
+    UCallable<float(float)> mp_get_power_threshold;
+    // tiles [x_begin, x_end) of a tile row whose pixels the ellipse d^T conic d <= threshold covers
+    UCallable<void(float2, float3, float, uint, uint2, uint2, uint2, uint&, uint&)> mp_get_tile_span;
+    // clamps a view space point to 1.3x the fov before the EWA jacobian
+    UCallable<float3(float3, float, float)> mp_cam_clamp;
+    // whether the 3 sigma sphere of a splat lies fully outside one of the side planes |x| = tan * z
+    UCallable<bool(float3, float3, float, float)> mp_outside_frustum;
     virtual void compile_callables(Device& device) noexcept;
 };
 
@@ -7,6 +7,7 @@
  */
 
 #include <luisa/runtime/buffer.h>
+#include "lcgs/util/splat_record.h"
 
 namespace lcgs
 {
@@ -41,6 +42,13 @@ struct GSSplatSHForwardInputProxy {
     luisa::float3                     bg_color = { 0.0f, 0.0f, 0.0f };
 };
 
+// how the splats of a pixel are composited
+enum class GSTileBlend : luisa::uint
+{
+    DepthSorted = 0, // front to back over the depth sorted tile lists
+    WeightedSum = 1  // order independent weighted sum, the tile lists are left unsorted
+};
+
 struct GSTileSplatterInputProxy {
     int           num_gaussians;
     luisa::float3 bg_color;
@@ -53,16 +61,34 @@ struct GSTileSplatterInputProxy {
     // payload
     luisa::compute::BufferView<float> color_features;   // 3 * P
     luisa::compute::BufferView<float> opacity_features; // P
+
+    // optional compacted ids of the gaussians to splat, e.g. the projector's frustum survivors,
+    // left empty every gaussian is splatted
+    luisa::compute::BufferView<luisa::uint> visible_ids; // P
+    luisa::compute::BufferView<luisa::uint> num_visible; // 1
+
+    // chosen per build, every rasterize of the build blends the same way
+    GSTileBlend blend = GSTileBlend::DepthSorted;
 };
 
+// the point lists (L sized keys and ids) are owned by GSTileSplatter and sized by num_rendered
 struct GSTileSplatterAccelProxy {
-    luisa::compute::BufferView<luisa::uint>  tiles_touched;            // P
-    luisa::compute::BufferView<luisa::uint>  point_offsets;            // P
-    luisa::compute::BufferView<luisa::ulong> point_list_keys_unsorted; // L
-    luisa::compute::BufferView<luisa::uint>  point_list_unsorted;      // L
-    luisa::compute::BufferView<luisa::ulong> point_list_keys;          // L
-    luisa::compute::BufferView<luisa::uint>  point_list;               // L
-    luisa::compute::BufferView<luisa::uint>  ranges;                   // TW x TH x 2
+    luisa::compute::BufferView<luisa::uint>   tiles_touched; // P
+    luisa::compute::BufferView<luisa::uint>   point_offsets; // P
+    luisa::compute::BufferView<luisa::uint>   ranges;        // TW x TH x 2
+    luisa::compute::BufferView<GSSplatRecord> records;       // P, written by allocate_tiles
+};
+
+// what GSTileSplatter::rasterize blends over a built binning
+struct GSTileSplatterPayloadProxy {
+    luisa::float3 bg_color = { 0.0f, 0.0f, 0.0f }; // background of the first three channels, the rest blend over 0
+    // optional per-gaussian features blended instead of the colors baked into the records,
+    // the target image then holds channels x H x W
+    luisa::compute::BufferView<float> features; // P x channels, the channels of a gaussian are adjacent
+    luisa::uint                       channels = 3u; // 1, 3, 4, 8, 16 or 32
+    // pixels of tiles without splats are only written when set,
+    // leave it off when the target and aux outputs already hold the background
+    bool clear_empty_tiles = true;
 };
 
 struct GSSplatForwardOutputProxy {
@@ -70,6 +96,14 @@ struct GSSplatForwardOutputProxy {
     int                               width;
     luisa::compute::BufferView<float> target_img; // hwc
     luisa::compute::BufferView<int>   radii;      // P
+
+    // optional, H x W each, written by the same blend pass when set
+    luisa::compute::BufferView<float>       alpha;        // 1 - T
+    luisa::compute::BufferView<float>       depth;        // expected view depth, normalized by alpha
+    // depth of the splat where T first drops below 0.5, the unsorted lists of GSTileBlend::WeightedSum
+    // have no such splat, their rasterize leaves it untouched
+    luisa::compute::BufferView<float>       median_depth;
+    luisa::compute::BufferView<luisa::uint> n_contrib;    // 1 + position of the last blended splat in the tile list
 };
 
 } // namespace lcgs
\ No newline at end of file
@@ -35,6 +35,18 @@ public:
         BufferView<float> color,
         int channel = 3, int level = 3
     ) noexcept;
+    // only evaluates the gaussians of a compacted visible list (e.g. GSProjector's frustum survivors),
+    // color of the others is left untouched
+    void process_visible(
+        CommandList&            cmdlist,
+        GPUPointsProxy          proxy,
+        lcgs::Camera&           camera,
+        BufferView<float>       sh,
+        BufferView<float>       color,
+        BufferView<luisa::uint> visible_ids,
+        BufferView<luisa::uint> num_visible,
+        int channel = 3, int level = 3
+    ) noexcept;
 
 private:
     void compile(Device& device) noexcept;
@@ -55,6 +67,17 @@ private:
              Buffer<float> // color
              >>
         shad_sh_process;
+
+    U<Shader<1, int, int, int, // P, channel, deg
+             float3,           // cam_pos
+             Buffer<float>,    // xyz
+             Buffer<float>,    // sh
+             Buffer<uint>,     // visible_ids
+             Buffer<uint>,     // num_visible
+             // ouitput
+             Buffer<float> // color
+             >>
+        shad_sh_process_visible;
 };
 
 } // namespace lcgs
\ No newline at end of file
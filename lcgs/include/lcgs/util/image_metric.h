@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * @file image_metric.h
+ * @brief The Host Image Metrics
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace lcgs
+{
+
+// mean squared error of two images of n floats
+inline double image_mse(const float* a, const float* b, size_t n) noexcept
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double d = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+        sum += d * d;
+    }
+    return n > 0 ? sum / static_cast<double>(n) : 0.0;
+}
+
+// peak signal to noise ratio in dB of two images with values in [0, peak], infinite when they are equal
+inline double image_psnr(const float* a, const float* b, size_t n, double peak = 1.0) noexcept
+{
+    double mse = image_mse(a, b, n);
+    if (mse <= 0.0) { return std::numeric_limits<double>::infinity(); }
+    return 10.0 * std::log10(peak * peak / mse);
+}
+
+} // namespace lcgs
@@ -0,0 +1,22 @@
+#pragma once
+/**
+ * @file splat_record.h
+ * @brief The Packed Per-Gaussian Render Record
+ */
+
+#include <luisa/dsl/struct.h>
+
+namespace lcgs
+{
+
+// everything the blend loop reads of a splat, written once by the preprocess
+struct GSSplatRecord {
+    luisa::float4 conic_opacity; // inverse 2d cov (xx, xy, yy), opacity
+    luisa::float3 color;
+    luisa::float2 mean;  // pixel space
+    float         depth; // view depth, fills the tail padding of the struct
+};
+
+} // namespace lcgs
+
+LUISA_STRUCT(lcgs::GSSplatRecord, conic_opacity, color, mean, depth) {};
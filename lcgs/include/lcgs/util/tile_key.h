@@ -0,0 +1,65 @@
+#pragma once
+/**
+ * @file tile_key.h
+ * @brief The Tile | Depth Sort Key Layout
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace lcgs
+{
+
+// key = (tile << depth_bits) | depth level
+// depth_bits = 32 keeps the float bits of the view depth, fewer bits keep a log level over [near, far]
+struct TileKeyLayout {
+    uint32_t tile_bits   = 32u;
+    uint32_t depth_bits  = 32u; // width of the depth field
+    float    depth_near  = 0.0f;
+    float    depth_scale = 0.0f; // levels per unit of log(depth / depth_near)
+
+    [[nodiscard]] uint32_t key_bits() const noexcept { return tile_bits + depth_bits; }
+    [[nodiscard]] bool     fits_32bit() const noexcept { return key_bits() <= 32u; }
+    [[nodiscard]] bool     quantized() const noexcept { return depth_bits > 0u && depth_bits < 32u; }
+    [[nodiscard]] uint32_t max_depth_level() const noexcept { return depth_bits >= 32u ? ~0u : (1u << depth_bits) - 1u; }
+};
+
+// a log scale spends the levels evenly on relative depth, which is how the splats spread in a
+// perspective view, depths outside [near, far] share the first or the last level
+inline TileKeyLayout make_tile_key_layout(uint32_t num_tiles, uint32_t depth_bits, float depth_near = 0.2f, float depth_far = 1000.0f) noexcept
+{
+    depth_bits = depth_bits < 1u ? 1u : (depth_bits > 32u ? 32u : depth_bits);
+    depth_near = depth_near > 1e-6f ? depth_near : 1e-6f;
+    depth_far  = depth_far > depth_near * 2.0f ? depth_far : depth_near * 2.0f;
+
+    TileKeyLayout layout;
+    // tile ids are < num_tiles < 2^tile_bits, so the all-ones key is free to pad the sort
+    layout.tile_bits   = static_cast<uint32_t>(std::bit_width(num_tiles));
+    layout.depth_bits  = depth_bits;
+    layout.depth_near  = depth_near;
+    layout.depth_scale = layout.quantized() ? static_cast<float>(layout.max_depth_level()) / std::log(depth_far / depth_near) : 0.0f;
+    return layout;
+}
+
+// the depth field of a key, copy_with_keys computes the same on the device
+inline uint32_t tile_key_depth(const TileKeyLayout& layout, float depth) noexcept
+{
+    if (layout.depth_bits == 0u) { return 0u; }
+    if (!layout.quantized()) { return std::bit_cast<uint32_t>(depth); }
+    float level = std::log(std::max(depth, layout.depth_near) / layout.depth_near) * layout.depth_scale;
+    level       = std::min(level, static_cast<float>(layout.max_depth_level()));
+    return std::min(static_cast<uint32_t>(level), layout.max_depth_level());
+}
+
+// key = tile, the depth order is carried by the order of the keys through a stable sort
+inline TileKeyLayout make_tile_only_key_layout(uint32_t num_tiles) noexcept
+{
+    TileKeyLayout layout;
+    layout.tile_bits   = static_cast<uint32_t>(std::bit_width(num_tiles));
+    layout.depth_bits  = 0u;
+    return layout;
+}
+
+} // namespace lcgs
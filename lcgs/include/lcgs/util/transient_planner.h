@@ -0,0 +1,54 @@
+#pragma once
+/**
+ * @file transient_planner.h
+ * @brief The Lifetime Based Placement of Transient Buffers in one Arena
+ */
+
+#include "lcgs/config.h"
+#include <luisa/core/stl.h>
+#include <cstdint>
+
+namespace lcgs
+{
+
+// transient buffers live from their first to their last stage (inclusive) of a pass,
+// two of them may share bytes of the arena when their stage ranges do not overlap
+class LCGS_API TransientPlanner
+{
+public:
+    static constexpr uint32_t invalid_id = ~0u;
+
+    struct Resource {
+        luisa::string name;
+        size_t        bytes       = 0u;
+        uint32_t      first_stage = 0u;
+        uint32_t      last_stage  = 0u;
+        size_t        offset      = 0u; // in bytes, valid after plan()
+    };
+
+    // returns the id of the resource, the offset of which is known after plan()
+    uint32_t add(luisa::string_view name, size_t bytes, uint32_t first_stage, uint32_t last_stage) noexcept;
+    // places the largest resources first, each at the lowest aligned offset that no live one covers
+    // returns the arena size in bytes
+    size_t plan(size_t alignment = 256u) noexcept;
+    void   clear() noexcept;
+
+    [[nodiscard]] size_t offset(uint32_t id) const noexcept { return m_resources[id].offset; }
+    [[nodiscard]] size_t bytes(uint32_t id) const noexcept { return m_resources[id].bytes; }
+    [[nodiscard]] size_t arena_bytes() const noexcept { return m_arena_bytes; }
+    // the sum of all resources, what separate buffers would take
+    [[nodiscard]] size_t unaliased_bytes() const noexcept;
+    // the largest sum of the resources live in one stage, no placement gets below it
+    [[nodiscard]] size_t peak_live_bytes() const noexcept;
+    [[nodiscard]] bool   lifetimes_overlap(uint32_t a, uint32_t b) const noexcept;
+    [[nodiscard]] const luisa::vector<Resource>& resources() const noexcept { return m_resources; }
+
+    // one line per resource and the arena against the unaliased and peak live sizes
+    void report(luisa::string_view owner) const noexcept;
+
+private:
+    luisa::vector<Resource> m_resources;
+    size_t                  m_arena_bytes = 0u;
+};
+
+} // namespace lcgs
@@ -0,0 +1,93 @@
+/**
+ * @file gs_fused_splatter/impl.cpp
+ * @brief The Gaussian Tile Splatter with a fused preprocess
+ */
+
+#include "lcgs/gs_fused_splatter.h"
+
+namespace lcgs
+{
+
+int GSFusedSplatter::forward(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSProjectorInputProxy     projection,
+    lcgs::Camera&             cam,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output
+) noexcept
+{
+    auto rendered = build(device, stream, accel, projection, cam, input, output);
+    rasterize(device, stream, accel, { .bg_color = input.bg_color }, output);
+    return rendered;
+}
+
+int GSFusedSplatter::build(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSProjectorInputProxy     projection,
+    lcgs::Camera&             cam,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output
+) noexcept
+{
+    auto fovy     = cam.fov / 180.0f * 3.1415926536f;
+    auto tanfovy  = tan(fovy * 0.5f);
+    auto tanfovx  = tanfovy * cam.aspect_ratio;
+    auto view_mat = world_to_local_matrix(cam);
+    auto proj_mat = projection_matrix(tanfovx, tanfovy);
+    auto focalx   = cam.width / (2.0f * tanfovx);
+    auto focaly   = cam.height / (2.0f * tanfovy);
+    // the cov3d slot needs a valid buffer even when it is not read
+    bool use_cov3d = projection.use_cov3d();
+    auto cov3d     = use_cov3d ? projection.cov3d : projection.scale;
+
+    // the preprocess in place of allocate_tiles, the camera of this call is captured by the stage
+    // it writes the depth during the allocation, so the temporal order is skipped
+    AllocateStage allocate{
+        .enqueue = [&](CommandList& cmdlist, GSTileSplatterAccelProxy accel, GSTileSplatterInputProxy input, GSSplatForwardOutputProxy output, GSVisibleSet, uint2 grids) {
+            auto resolution = luisa::make_uint2(output.width, output.height);
+            cmdlist
+                << (*shad_preprocess)(
+                       projection.num_gaussians,
+                       // input
+                       projection.pos,
+                       projection.scale,
+                       projection.rotq,
+                       projection.scale_modifier,
+                       cov3d,
+                       use_cov3d,
+                       input.opacity_features,
+                       input.color_features,
+                       // output
+                       input.means_2d,
+                       input.depth_features,
+                       input.conic,
+                       accel.tiles_touched,
+                       output.radii,
+                       accel.records,
+                       // params
+                       m_guard_band,
+                       tanfovx,
+                       tanfovy,
+                       focalx,
+                       focaly,
+                       view_mat,
+                       proj_mat,
+                       resolution,
+                       grids
+                   )
+                       .dispatch(projection.num_gaussians);
+        },
+        .depth_ready = false
+    };
+
+    // every gaussian gets a slot, the preprocess culls in place
+    input.visible_ids = {};
+    input.num_visible = {};
+    return build_staged(device, stream, accel, input, output, allocate);
+}
+
+} // namespace lcgs
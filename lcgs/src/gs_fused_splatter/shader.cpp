@@ -0,0 +1,124 @@
+/**
+ * @file gs_fused_splatter/shader.cpp
+ * @brief The Fused Projection + Tile Allocation Shader
+ */
+
+#include "lcgs/gs_fused_splatter.h"
+#include "lcgs/core/sugar.h"
+#include "lcgs/util/gaussian.hpp"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+
+void GSFusedSplatter::compile(Device& device) noexcept
+{
+    GSTileSplatter::compile(device);
+    compile_preprocess_shader(device);
+    if (m_config.temporal_order)
+    {
+        LUISA_WARNING("GSFusedSplatter: the fused preprocess writes the depth in place of the allocation, the temporal depth order only applies to the split path");
+    }
+}
+
+void GSFusedSplatter::compile_preprocess_shader(Device& device) noexcept
+{
+    lazy_compile(
+        device, shad_preprocess,
+        [&](
+            Int P,
+            // input
+            BufferVar<float> means_3d,
+            BufferVar<float> scale_buffer,
+            BufferVar<float> rotq_buffer,
+            Float            scale_modifier,
+            BufferVar<float> cov3d,
+            Bool             use_cov3d,
+            BufferVar<float> opacity_features,
+            BufferVar<float> color_features,
+            // output
+            BufferVar<float>         means_2d,
+            BufferVar<float>         depth_features,
+            BufferVar<float>         conic_buffer,
+            BufferVar<uint>          tiles_touched,
+            BufferVar<int>           radii,
+            BufferVar<GSSplatRecord> records,
+            // params
+            Float    guard_band,
+            Float    tanfovx,
+            Float    tanfovy,
+            Float    focalx,
+            Float    focaly,
+            Float4x4 view_matrix,
+            Float4x4 proj_matrix,
+            UInt2    resolution,
+            UInt2    grids
+        ) {
+            set_block_size(m_blocks.x * m_blocks.y);
+            auto idx = dispatch_id().x;
+            $if(idx >= UInt(P)) { $return(); };
+            radii.write(idx, 0);
+            tiles_touched.write(idx, 0u);
+
+            // -----------------------------
+            // project to screen space, same as GSProjector with focal
+            // -----------------------------
+            auto   mean_3d    = read_float3(means_3d, idx);
+            Float4 p_hom      = make_float4(mean_3d, 1.0f);
+            Float4 p_view_hom = view_matrix * p_hom;
+            Float3 p_view     = p_view_hom.xyz();
+            Float4 p_proj_hom = proj_matrix * p_view_hom;
+            Float  p_w        = 1.0f / (p_proj_hom.w + 1e-6f);
+            Float2 xy_ndc     = p_proj_hom.xy() * p_w;
+
+            $if(p_view.z < 0.2f) { $return(); };
+            Float3x3 cov_3d;
+            Float3   scale;
+            $if(use_cov3d)
+            {
+                cov_3d = read_sym3x3(cov3d, idx);
+                scale  = make_float3(sqrt(cov_3d[0][0] + cov_3d[1][1] + cov_3d[2][2]));
+            }
+            $else
+            {
+                Float3 s    = read_float3(scale_buffer, idx);
+                Float4 rotq = read_float4(rotq_buffer, idx); // r, x, y, z
+                scale       = scale_modifier * s;
+                cov_3d      = calc_cov<Float3, Float4, Float3x3>(scale, rotq.yzwx());
+            };
+            $if((*mp_outside_frustum)(p_view, scale, tanfovx * guard_band, tanfovy * guard_band)) { $return(); };
+
+            Float3   t      = (*mp_cam_clamp)(p_view, tanfovx, tanfovy);
+            Float3x3 cov    = ewasplat_cov_focal<Float3x3, Float4x4, Float3, Float>(cov_3d, t, view_matrix, focalx, focaly);
+            Float3   cov_2d = make_float3(cov[0][0], cov[0][1], cov[1][1]);
+
+            // -----------------------------
+            // allocate tiles, same as shad_allocate_tiles
+            // -----------------------------
+            auto   point_image = make_float2((*mp_ndc2pix)(xy_ndc.x, resolution.x), (*mp_ndc2pix)(xy_ndc.y, resolution.y));
+            Float  opacity     = opacity_features.read(idx);
+            Float3 conic;
+            Int    my_radius;
+            UInt   N_tiles_touched;
+            (*mp_splat_footprint)(point_image, cov_2d, opacity, grids, conic, my_radius, N_tiles_touched);
+            $if(my_radius <= 0) { $return(); };
+
+            // write out, the key and binning stages still read means_2d, conic and depth
+            depth_features.write(idx, p_view.z);
+            radii.write(idx, my_radius);
+            tiles_touched.write(idx, N_tiles_touched);
+            write_float3(conic_buffer, idx, conic);
+            write_float2(means_2d, idx, point_image);
+            Var<GSSplatRecord> record;
+            record.conic_opacity = make_float4(conic, opacity);
+            record.color         = read_float3(color_features, idx);
+            record.mean          = point_image;
+            record.depth         = p_view.z;
+            records.write(idx, record);
+        }
+    );
+}
+
+} // namespace lcgs
@@ -11,18 +11,37 @@
 namespace lcgs
 {
 
-void GSProjector::create(Device& device) noexcept
+void GSProjector::create(Device& device, uint2 tile_size) noexcept
 {
+    m_blocks = tile_size;
+    if (m_blocks.x == 0u || m_blocks.y == 0u || m_blocks.x * m_blocks.y > max_tile_threads)
+    {
+        LUISA_ERROR("GSProjector: unsupported tile size {}x{}", m_blocks.x, m_blocks.y);
+    }
     compile(device);
+    m_dummy_uint = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(1u));
     LUISA_INFO("GS Projector created");
 }
 
 void GSProjector::compile(Device& device) noexcept
 {
-    compile_callables(device);
+    GSModule::compile_callables(device);
     compile_gs_project_shader(device);
 }
 
+void GSProjector::precompute_cov3d(CommandList& cmdlist, GSProjectorInputProxy input, BufferView<float> cov3d) noexcept
+{
+    cmdlist
+        << (*shad_precompute_cov3d)(
+               input.num_gaussians,
+               input.scale,
+               input.rotq,
+               input.scale_modifier,
+               cov3d
+           )
+               .dispatch(input.num_gaussians);
+}
+
 void GSProjector::forward(
     CommandList&           cmdlist,
     GSProjectorInputProxy  input,
@@ -41,6 +60,20 @@ void GSProjector::forward(
     auto focalx = cam.width / (2.0f * tanfovx);
     auto focaly = cam.height / (2.0f * tanfovy);
 
+    bool use_cov3d = input.use_cov3d();
+    // the cov3d slot needs a valid buffer even when it is not read
+    auto cov3d = use_cov3d ? input.cov3d : input.scale;
+
+    // survivors of the frustum culling are appended to visible_ids when the output has one
+    bool compact     = output.visible_ids.size() > 0;
+    auto visible_ids = compact ? output.visible_ids : m_dummy_uint->view();
+    auto num_visible = compact ? output.num_visible : m_dummy_uint->view();
+    if (compact)
+    {
+        static constexpr uint zero = 0u;
+        cmdlist << output.num_visible.copy_from(&zero);
+    }
+
     // world -> screen -> ndc
     if (use_focal)
     {
@@ -57,6 +90,12 @@ void GSProjector::forward(
                    output.means_2d,
                    output.depth,
                    output.covs_2d,
+                   visible_ids,
+                   num_visible,
+                   compact,
+                   m_guard_band,
+                   cov3d,
+                   use_cov3d,
                    // camera
                    tanfovx,
                    tanfovy,
@@ -82,6 +121,12 @@ void GSProjector::forward(
                    output.means_2d,
                    output.depth,
                    output.covs_2d,
+                   visible_ids,
+                   num_visible,
+                   compact,
+                   m_guard_band,
+                   cov3d,
+                   use_cov3d,
                    // camera
                    tanfovx,
                    tanfovy,
@@ -17,6 +17,24 @@ using namespace luisa::compute;
 
 void GSProjector::compile_gs_project_shader(Device& device) noexcept
 {
+    lazy_compile(
+        device, shad_precompute_cov3d,
+        [&](
+            Int              P,
+            BufferVar<float> scale_buffer,
+            BufferVar<float> rotq_buffer,
+            Float            scale_modifier,
+            BufferVar<float> cov3d
+        ) {
+            set_block_size(m_blocks.x * m_blocks.y);
+            auto idx = dispatch_id().x;
+            $if(idx >= UInt(P)) { $return(); };
+            auto scale = scale_modifier * read_float3(scale_buffer, idx);
+            auto qvec  = read_float4(rotq_buffer, idx).yzwx(); // rxyz -> xyzw
+            write_sym3x3(cov3d, idx, calc_cov<Float3, Float4, Float3x3>(scale, qvec));
+        }
+    );
+
     lazy_compile(
         device, shad_project_gs,
         [&](
@@ -31,6 +49,12 @@ void GSProjector::compile_gs_project_shader(Device& device) noexcept
             BufferVar<float> means_2d,
             BufferVar<float> depth_features,
             BufferVar<float> covs_2d,
+            BufferVar<uint>  visible_ids,
+            BufferVar<uint>  num_visible,
+            Bool             compact,
+            Float            guard_band,
+            BufferVar<float> cov3d,
+            Bool             use_cov3d,
             // camera
             Float    tanfovx,
             Float    tanfovy,
@@ -53,20 +77,34 @@ void GSProjector::compile_gs_project_shader(Device& device) noexcept
             Float3 p_proj     = p_proj_hom.xyz() * p_w; // p_proj in NDC
             // Float2 xy_ndc = make_float2(p_proj.x / tanfovx, p_proj.y / tanfovy);
             Float2 xy_ndc = p_proj.xy();
+            // every gaussian gets a depth, the temporal depth order of the splatter sorts all P
+            // culled ones are marked invalid, they sort to the back and allocate_tiles skips their stale 2d splat
+            depth_features.write(idx, -1.0f);
 
             $if(p_view.z < 0.2f) { $return(); };
-            depth_features.write(idx, p_view.z);
+            // calculate 3d covariance, or read the cached one
+            Float3x3 cov_3d;
+            Float3   scale;
+            $if(use_cov3d)
+            {
+                cov_3d = read_sym3x3(cov3d, idx);
+                // sigma_max^2 <= trace, a conservative sphere for the culling
+                scale = make_float3(sqrt(cov_3d[0][0] + cov_3d[1][1] + cov_3d[2][2]));
+            }
+            $else
+            {
+                Float3 s    = read_float3(scale_buffer, idx);
+                Float4 rotq = read_float4(rotq_buffer, idx); // r, x, y, z
+                scale       = scale_modifier * s;
+                // auto scale = make_float3(0.001f);
+                auto qvec = rotq.yzwx(); // rxyz -> xyzw
+                // auto qvec = make_float4(0.0f, 0.0f, 0.0f, 1.0f); // rxyz -> xyzw
+                cov_3d = calc_cov<Float3, Float4, Float3x3>(scale, qvec);
+            };
+            $if((*mp_outside_frustum)(p_view, scale, tanfovx * guard_band, tanfovy * guard_band)) { $return(); };
 
+            depth_features.write(idx, p_view.z);
             write_float2(means_2d, idx, xy_ndc);
-            // calculate 3d covariance
-            Float3 s     = read_float3(scale_buffer, idx);
-            Float4 rotq  = read_float4(rotq_buffer, idx); // r, x, y, z
-            auto   scale = scale_modifier * s;
-            // auto scale = make_float3(0.001f);
-            auto qvec = rotq.yzwx(); // rxyz -> xyzw
-            // auto qvec = make_float4(0.0f, 0.0f, 0.0f, 1.0f); // rxyz -> xyzw
-
-            Float3x3 cov_3d = calc_cov<Float3, Float4, Float3x3>(scale, qvec);
             Float3   t      = (*mp_cam_clamp)(p_view_hom.xyz(), tanfovx, tanfovy);
             Float3x3 cov    = ewasplat_cov<Float3x3, Float4x4, Float3>(cov_3d, t, view_matrix);
 
@@ -76,6 +114,8 @@ void GSProjector::compile_gs_project_shader(Device& device) noexcept
             cov_2d.z      = cov_2d.z * 1.0f / (tanfovy * tanfovy);
 
             write_float3(covs_2d, idx, cov_2d);
+            // compact the survivors, the splatter walks this list instead of all P
+            $if(compact) { visible_ids.write(num_visible.atomic(0).fetch_add(1u), idx); };
         }
     );
 
@@ -93,6 +133,12 @@ void GSProjector::compile_gs_project_shader(Device& device) noexcept
             BufferVar<float> means_2d,
             BufferVar<float> depth_features,
             BufferVar<float> covs_2d,
+            BufferVar<uint>  visible_ids,
+            BufferVar<uint>  num_visible,
+            Bool             compact,
+            Float            guard_band,
+            BufferVar<float> cov3d,
+            Bool             use_cov3d,
             // camera
             Float    tanfovx,
             Float    tanfovy,
@@ -117,45 +163,42 @@ void GSProjector::compile_gs_project_shader(Device& device) noexcept
             Float3 p_proj     = p_proj_hom.xyz() * p_w; // p_proj in NDC
             // Float2 xy_ndc = make_float2(p_proj.x / tanfovx, p_proj.y / tanfovy);
             Float2 xy_ndc = p_proj.xy();
+            // every gaussian gets a depth, the temporal depth order of the splatter sorts all P
+            // culled ones are marked invalid, they sort to the back and allocate_tiles skips their stale 2d splat
+            depth_features.write(idx, -1.0f);
 
             $if(p_view.z < 0.2f) { $return(); };
-            depth_features.write(idx, p_view.z);
+            // calculate 3d covariance, or read the cached one
+            Float3x3 cov_3d;
+            Float3   scale;
+            $if(use_cov3d)
+            {
+                cov_3d = read_sym3x3(cov3d, idx);
+                // sigma_max^2 <= trace, a conservative sphere for the culling
+                scale = make_float3(sqrt(cov_3d[0][0] + cov_3d[1][1] + cov_3d[2][2]));
+            }
+            $else
+            {
+                Float3 s    = read_float3(scale_buffer, idx);
+                Float4 rotq = read_float4(rotq_buffer, idx); // r, x, y, z
+                scale       = scale_modifier * s;
+                // auto scale = make_float3(0.001f);
+                auto qvec = rotq.yzwx(); // rxyz -> xyzw
+                // auto qvec = make_float4(0.0f, 0.0f, 0.0f, 1.0f); // rxyz -> xyzw
+                cov_3d = calc_cov<Float3, Float4, Float3x3>(scale, qvec);
+            };
+            $if((*mp_outside_frustum)(p_view, scale, tanfovx * guard_band, tanfovy * guard_band)) { $return(); };
 
+            depth_features.write(idx, p_view.z);
             write_float2(means_2d, idx, xy_ndc);
-            // calculate 3d covariance
-            Float3 s     = read_float3(scale_buffer, idx);
-            Float4 rotq  = read_float4(rotq_buffer, idx); // r, x, y, z
-            auto   scale = scale_modifier * s;
-            // auto scale = make_float3(0.001f);
-            auto qvec = rotq.yzwx(); // rxyz -> xyzw
-            // auto qvec = make_float4(0.0f, 0.0f, 0.0f, 1.0f); // rxyz -> xyzw
-
-            Float3x3 cov_3d = calc_cov<Float3, Float4, Float3x3>(scale, qvec);
             Float3   t      = (*mp_cam_clamp)(p_view_hom.xyz(), tanfovx, tanfovy);
             Float3x3 cov    = ewasplat_cov_focal<Float3x3, Float4x4, Float3, Float>(cov_3d, t, view_matrix, focalx, focaly);
             Float3   cov_2d = make_float3(cov[0][0], cov[0][1], cov[1][1]);
             write_float3(covs_2d, idx, cov_2d);
+            // compact the survivors, the splatter walks this list instead of all P
+            $if(compact) { visible_ids.write(num_visible.atomic(0).fetch_add(1u), idx); };
         }
     );
 }
 
-void GSProjector::compile_callables(Device& device) noexcept
-{
-    GSModule::compile_callables(device);
-
-    mp_cam_clamp = luisa::make_unique<Callable<float3(float3, float, float)>>(
-        [](Float3 p, Float tanfovx, Float tanfovy) {
-            auto t    = p;
-            auto limx = 1.3f * tanfovx;
-            auto limy = 1.3f * tanfovy;
-            auto txtz = t.x / t.z;
-            auto tytz = t.y / t.z;
-            // use luisa::compute::clamp for CallOp::CLAMP
-            t.x = luisa::compute::clamp(txtz, -limx, limx) * t.z;
-            t.y = luisa::compute::clamp(tytz, -limy, limy) * t.z;
-            return t;
-        }
-    );
-}
-
-} // namespace lcgs
\ No newline at end of file
+} // namespace lcgs
@@ -0,0 +1,394 @@
+/**
+ * @file gs_tile_splatter/active_tiles.cpp
+ * @brief The Work List of Active and Split Tiles for the Gaussian Tile Splatter
+ */
+
+#include "lcgs/gs_tile_splatter.h"
+#include "lcgs/core/sugar.h"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+
+void GSTileSplatter::ensure_active_tile_buffers(Device& device, size_t num_tiles)
+{
+    if (m_work_items == nullptr || m_work_list_tiles < num_tiles)
+    {
+        // whole tiles take one item each, a split tile one more per extra chunk, bounded by its partial slots
+        auto max_items    = num_tiles + m_config.tile_split_max_partials;
+        m_work_unordered  = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(2u * max_items));
+        m_work_items      = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(2u * max_items));
+        m_work_buckets    = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(2u * work_buckets));
+        m_work_counts     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(7u));
+        m_tile_splits     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(2u * num_tiles));
+        m_split_tiles     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(num_tiles));
+        m_render_args     = luisa::make_unique<IndirectDispatchBuffer>(device.create_indirect_dispatch_buffer(1u));
+        m_composite_args  = luisa::make_unique<IndirectDispatchBuffer>(device.create_indirect_dispatch_buffer(1u));
+        m_work_list_tiles = num_tiles;
+        LUISA_INFO("GSTileSplatter: work list buffers resized to {} tiles", num_tiles);
+    }
+}
+
+void GSTileSplatter::ensure_partial_buffer(Device& device, Stream& stream, uint channels)
+{
+    auto size = static_cast<size_t>(m_config.tile_split_max_partials) * m_blocks.x * m_blocks.y * (channels + partial_fields);
+    if (m_partials == nullptr || m_partials->size() < size)
+    {
+        // the last rasterize may still read the old buffer
+        if (m_partials != nullptr) { stream << synchronize(); }
+        m_partials = luisa::make_unique<Buffer<float>>(device.create_buffer<float>(size));
+        LUISA_INFO("GSTileSplatter: partial buffer resized to {} MB for {} channels", (size * sizeof(float)) >> 20u, channels);
+    }
+}
+
+void GSTileSplatter::enqueue_active_tiles(
+    Device&                  device,
+    CommandList&             cmdlist,
+    GSTileSplatterAccelProxy accel,
+    uint2                    grids
+) noexcept
+{
+    auto num_tiles = grids.x * grids.y;
+    auto split     = m_config.tile_split_size;
+    ensure_active_tile_buffers(device, num_tiles);
+    auto max_items = static_cast<int>(m_work_list_tiles + m_config.tile_split_max_partials);
+    cmdlist << mp_buffer_filler->fill(device, m_work_counts->view(), 0u)
+            << mp_buffer_filler->fill(device, m_work_buckets->view(), 0u);
+    if (split > 0u)
+    {
+        // the mean list length of the non-empty tiles sets the bar of a heavy tile
+        cmdlist << (*shad_tile_stats)(
+                       static_cast<int>(num_tiles),
+                       accel.ranges,
+                       m_work_counts->view()
+        )
+                       .dispatch(num_tiles);
+    }
+    cmdlist << (*shad_build_work_list)(
+                   static_cast<int>(num_tiles),
+                   accel.ranges,
+                   m_work_unordered->view(),
+                   m_work_counts->view(),
+                   m_tile_splits->view(),
+                   m_split_tiles->view(),
+                   split,
+                   m_config.tile_split_factor,
+                   std::max(m_config.tile_split_max_chunks, 1u),
+                   m_config.tile_split_max_partials
+    )
+                   .dispatch(num_tiles);
+    // the item count stays on the device, the passes over the items cover the largest list
+    cmdlist << (*shad_work_histogram)(
+                   max_items,
+                   accel.ranges,
+                   m_work_unordered->view(),
+                   m_work_counts->view(),
+                   m_tile_splits->view(),
+                   m_work_buckets->view()
+    )
+                   .dispatch(max_items);
+    cmdlist << (*shad_work_bucket_offsets)(m_work_buckets->view()).dispatch(1u);
+    cmdlist << (*shad_order_work_queue)(
+                   max_items,
+                   accel.ranges,
+                   m_work_unordered->view(),
+                   m_work_counts->view(),
+                   m_tile_splits->view(),
+                   m_work_buckets->view(),
+                   m_work_items->view()
+    )
+                   .dispatch(max_items);
+    cmdlist << (*shad_active_tile_args)(
+                   m_work_counts->view(),
+                   m_blocks / m_config.pixels_per_thread,
+                   grids,
+                   m_config.persistent_blocks,
+                   *m_render_args,
+                   *m_composite_args
+    )
+                   .dispatch(1u);
+}
+
+void GSTileSplatter::compile_active_tile_shader(Device& device) noexcept
+{
+    lazy_compile(
+        device, shad_tile_stats,
+        [&](Int num_tiles, BufferVar<uint> ranges, BufferVar<uint> work_counts) {
+            set_block_size(256);
+            auto tile_id = dispatch_id().x;
+            $if(tile_id >= UInt(num_tiles)) { $return(); };
+            auto len = ranges.read(2u * tile_id + 1u) - ranges.read(2u * tile_id + 0u);
+            $if(len > 0u)
+            {
+                work_counts.atomic(3).fetch_add(1u);
+                work_counts.atomic(4).fetch_add(len);
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_build_work_list,
+        [&](
+            Int             num_tiles,
+            BufferVar<uint> ranges,
+            BufferVar<uint> work_items,
+            BufferVar<uint> work_counts,
+            BufferVar<uint> tile_splits,
+            BufferVar<uint> split_tiles,
+            UInt            split_size,
+            Float           split_factor,
+            UInt            max_chunks,
+            UInt            max_partials
+        ) {
+            set_block_size(256);
+            auto tile_id = dispatch_id().x;
+            $if(tile_id >= UInt(num_tiles)) { $return(); };
+            auto len = ranges.read(2u * tile_id + 1u) - ranges.read(2u * tile_id + 0u);
+            $if(len == 0u) { $return(); };
+
+            UInt chunks = 1u;
+            UInt base   = ~0u;
+            $if(split_size > 0u)
+            {
+                auto mean  = cast<float>(work_counts.read(4)) / cast<float>(max(work_counts.read(3), 1u));
+                auto heavy = (len > 2u * split_size) & (cast<float>(len) > split_factor * mean);
+                $if(heavy)
+                {
+                    auto n    = min((len + split_size - 1u) / split_size, max_chunks);
+                    auto slot = work_counts.atomic(2).fetch_add(n);
+                    // out of partial slots, the tile stays whole
+                    $if(slot + n <= max_partials)
+                    {
+                        chunks = n;
+                        base   = slot;
+                        split_tiles.write(work_counts.atomic(1).fetch_add(1u), tile_id);
+                    };
+                };
+            };
+            tile_splits.write(2u * tile_id + 0u, base);
+            tile_splits.write(2u * tile_id + 1u, chunks);
+            auto item = work_counts.atomic(0).fetch_add(chunks);
+            $for(c, chunks)
+            {
+                work_items.write(2u * (item + c) + 0u, tile_id);
+                work_items.write(2u * (item + c) + 1u, c);
+            };
+        }
+    );
+
+    // the bucket of an item, lists twice as long land one bucket earlier
+    auto work_bucket = [](BufferVar<uint>& ranges, BufferVar<uint>& tile_splits, UInt tile_id) {
+        auto len    = ranges.read(2u * tile_id + 1u) - ranges.read(2u * tile_id + 0u);
+        auto chunks = tile_splits.read(2u * tile_id + 1u);
+        return clz(max((len + chunks - 1u) / chunks, 1u));
+    };
+
+    lazy_compile(
+        device, shad_work_histogram,
+        [&](Int max_items, BufferVar<uint> ranges, BufferVar<uint> work_unordered, BufferVar<uint> work_counts, BufferVar<uint> tile_splits, BufferVar<uint> buckets) {
+            set_block_size(256);
+            auto item = dispatch_id().x;
+            $if((item >= UInt(max_items)) | (item >= work_counts.read(0))) { $return(); };
+            auto tile_id = work_unordered.read(2u * item + 0u);
+            buckets.atomic(work_bucket(ranges, tile_splits, tile_id)).fetch_add(1u);
+        }
+    );
+
+    lazy_compile(
+        device, shad_work_bucket_offsets,
+        [&](BufferVar<uint> buckets) {
+            set_block_size(1);
+            UInt offset = 0u;
+            $for(b, work_buckets)
+            {
+                auto count = buckets.read(b);
+                buckets.write(work_buckets + b, offset);
+                offset = offset + count;
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_work_queue,
+        [&](Int max_items, BufferVar<uint> ranges, BufferVar<uint> work_unordered, BufferVar<uint> work_counts, BufferVar<uint> tile_splits, BufferVar<uint> buckets, BufferVar<uint> work_items) {
+            set_block_size(256);
+            auto item = dispatch_id().x;
+            $if((item >= UInt(max_items)) | (item >= work_counts.read(0))) { $return(); };
+            auto tile_id = work_unordered.read(2u * item + 0u);
+            auto bucket  = work_bucket(ranges, tile_splits, tile_id);
+            auto slot    = buckets.atomic(work_buckets + bucket).fetch_add(1u);
+            work_items.write(2u * slot + 0u, tile_id);
+            work_items.write(2u * slot + 1u, work_unordered.read(2u * item + 1u));
+        }
+    );
+
+    lazy_compile(
+        device, shad_active_tile_args,
+        [&](BufferVar<uint> work_counts, UInt2 block, UInt2 grids, UInt persistent_blocks, Var<IndirectDispatchBuffer> render_args, Var<IndirectDispatchBuffer> composite_args) {
+            set_block_size(1);
+            // blocks fill the rows from the left, split tiles may add rows past the full-frame grid
+            // the last row is launched whole, its blocks past count leave before taking an item
+            auto count = ite(persistent_blocks > 0u, min(work_counts.read(0), persistent_blocks), work_counts.read(0));
+            auto rows  = (count + grids.x - 1u) / grids.x;
+            work_counts.write(6u, count);
+            $if(count == 0u)
+            {
+                render_args.set_dispatch_count(0u);
+            }
+            $else
+            {
+                render_args.set_dispatch_count(1u);
+                render_args.set_kernel(0u, make_uint3(block, 1u), make_uint3(grids.x * block.x, rows * block.y, 1u), 0u);
+            };
+            auto tile   = make_uint2(m_blocks.x, m_blocks.y);
+            auto splits = work_counts.read(1);
+            $if(splits == 0u)
+            {
+                composite_args.set_dispatch_count(0u);
+            }
+            $else
+            {
+                composite_args.set_dispatch_count(1u);
+                composite_args.set_kernel(0u, make_uint3(tile, 1u), make_uint3(splits * tile.x, tile.y, 1u), 0u);
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_composite_split_tiles,
+        [&](
+            UInt2            resolution,
+            UInt2            grids,
+            BufferVar<uint>  ranges,
+            BufferVar<uint>  work_counts,
+            BufferVar<uint>  tile_splits,
+            BufferVar<uint>  split_tiles,
+            BufferVar<float> partials,
+            BufferVar<float> target_img,
+            UInt             channels,
+            Float3           bg_color,
+            Bool             weighted_sum,
+            BufferVar<float> alpha,
+            BufferVar<float> depth,
+            BufferVar<float> median_depth,
+            BufferVar<uint>  n_contrib,
+            UInt             aux_mask
+        ) {
+            set_block_size(m_blocks);
+            auto split_idx = block_id().x;
+            $if(split_idx >= work_counts.read(1)) { $return(); };
+            auto tile_id     = split_tiles.read(split_idx);
+            auto tile_xy     = make_uint2(tile_id % grids.x, tile_id / grids.x);
+            auto xy          = tile_xy * m_blocks + thread_id().xy();
+            $if((xy.x >= resolution.x) | (xy.y >= resolution.y)) { $return(); };
+            auto tile_pixels = m_blocks.x * m_blocks.y;
+            auto local_id    = thread_id().x + thread_id().y * m_blocks.x;
+            auto base        = tile_splits.read(2u * tile_id + 0u);
+            auto chunks      = tile_splits.read(2u * tile_id + 1u);
+            auto stride      = channels + partial_fields;
+            // field f of the partial result of chunk c, see blend_tile
+            auto partial = [&](UInt c, UInt f) { return partials.read(((base + c) * stride + f) * tile_pixels + local_id); };
+
+            // the chunks are in list order, each blended from T = 1
+            Float T      = 1.0f;
+            Float D      = 0.0f;
+            Float W      = 0.0f;
+            Float median = 0.0f;
+            UInt  last   = 0u;
+            $for(c, chunks)
+            {
+                Float Tc    = partial(c, channels);
+                Float front = ite(weighted_sum, 1.0f, T);
+                D           = D + front * partial(c, channels + 1u);
+                W           = W + partial(c, channels + 2u);
+                // the running T crosses 0.5 in this chunk where the chunk's own T crosses 0.5 / T,
+                // the nearest step the chunk reached stands in, the step at 1 is reached by any covering chunk
+                $if((T > 0.5f) & (T * Tc <= 0.5f))
+                {
+                    Float crossing = 0.5f / T;
+                    Float nearest  = 2.0f;
+                    $if(Tc <= 0.5f)
+                    {
+                        median  = partial(c, channels + 3u);
+                        nearest = crossing - 0.5f;
+                    };
+                    for (auto s = 0u; s < median_steps; s++)
+                    {
+                        float step = 1.0f - static_cast<float>(s) / (2.0f * median_steps);
+                        Float dist = abs(step - crossing);
+                        $if((Tc < step) & (dist < nearest))
+                        {
+                            median  = partial(c, channels + 5u + s);
+                            nearest = dist;
+                        };
+                    }
+                };
+                UInt lc = cast<uint>(partial(c, channels + 4u));
+                // the sorted blend stops at T < 0.0001, the later chunks did not know
+                $if((lc > 0u) & (weighted_sum | (T >= 0.0001f))) { last = lc; };
+                T = T * Tc;
+            };
+            Float a     = 1.0f - T;
+            Float scale = ite(weighted_sum, ite(W > 0.0f, a / W, 0.0f), 1.0f);
+
+            auto n_pixels = resolution.x * resolution.y;
+            auto pix_id   = xy.x + xy.y * resolution.x;
+            $for(ch, channels)
+            {
+                Float C      = 0.0f;
+                Float prefix = 1.0f;
+                $for(c, chunks)
+                {
+                    C      = C + ite(weighted_sum, 1.0f, prefix) * partial(c, ch);
+                    prefix = prefix * partial(c, channels);
+                };
+                Float bg = ite(ch == 0u, bg_color.x, ite(ch == 1u, bg_color.y, ite(ch == 2u, bg_color.z, 0.0f)));
+                target_img.write(pix_id + ch * n_pixels, bg * T + C * scale);
+            };
+            $if((aux_mask & aux_alpha) != 0u) { alpha.write(pix_id, a); };
+            $if((aux_mask & aux_depth) != 0u) { depth.write(pix_id, ite(a > 0.0f, D * scale / a, 0.0f)); };
+            $if((aux_mask & aux_median_depth) != 0u) { median_depth.write(pix_id, median); };
+            $if((aux_mask & aux_n_contrib) != 0u) { n_contrib.write(pix_id, last); };
+        }
+    );
+
+    lazy_compile(
+        device, shad_fill_empty_tiles,
+        [&](
+            UInt2            resolution,
+            UInt2            grids,
+            BufferVar<uint>  ranges,
+            BufferVar<float> target_img,
+            UInt             channels,
+            Float3           bg_color,
+            BufferVar<float> alpha,
+            BufferVar<float> depth,
+            BufferVar<float> median_depth,
+            BufferVar<uint>  n_contrib,
+            UInt             aux_mask
+        ) {
+            set_block_size(m_blocks);
+            auto xy = dispatch_id().xy();
+            $if((xy.x >= resolution.x) | (xy.y >= resolution.y)) { $return(); };
+            auto tile    = xy / m_blocks;
+            auto tile_id = tile.x + tile.y * grids.x;
+            // the render kernels own the pixels of non-empty tiles
+            $if(ranges.read(2u * tile_id + 1u) > ranges.read(2u * tile_id + 0u)) { $return(); };
+            auto n_pixels = resolution.x * resolution.y;
+            auto pix_id   = xy.x + xy.y * resolution.x;
+            $for(c, channels)
+            {
+                Float bg = ite(c == 0u, bg_color.x, ite(c == 1u, bg_color.y, ite(c == 2u, bg_color.z, 0.0f)));
+                target_img.write(pix_id + c * n_pixels, bg);
+            };
+            $if((aux_mask & aux_alpha) != 0u) { alpha.write(pix_id, 0.0f); };
+            $if((aux_mask & aux_depth) != 0u) { depth.write(pix_id, 0.0f); };
+            $if((aux_mask & aux_median_depth) != 0u) { median_depth.write(pix_id, 0.0f); };
+            $if((aux_mask & aux_n_contrib) != 0u) { n_contrib.write(pix_id, 0u); };
+        }
+    );
+}
+
+} // namespace lcgs
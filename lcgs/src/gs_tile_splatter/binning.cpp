@@ -0,0 +1,400 @@
+/**
+ * @file gs_tile_splatter/binning.cpp
+ * @brief The Counting Sort Tile Binning for the Gaussian Tile Splatter
+ */
+
+#include "lcgs/gs_tile_splatter.h"
+#include "lcgs/core/sugar.h"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+
+void GSTileSplatter::enqueue_bin_count(
+    Device&                   device,
+    CommandList&              cmdlist,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    GSVisibleSet              visible,
+    uint2                     grids
+) noexcept
+{
+    auto num_tiles      = grids.x * grids.y;
+    auto d_tile_counts  = transient_view<uint>(m_transients.tile_counts).subview(0, num_tiles);
+    auto d_tile_offsets = transient_view<uint>(m_transients.tile_offsets).subview(0, num_tiles);
+
+    cmdlist << mp_buffer_filler->fill(device, d_tile_counts, 0u);
+    cmdlist << (*shad_bin_count)(
+                   static_cast<int>(visible.bound),
+                   input.means_2d,
+                   input.conic,
+                   input.opacity_features,
+                   output.radii,
+                   d_tile_counts,
+                   m_blocks, grids,
+                   visible.ids,
+                   visible.count,
+                   visible.compacted
+    )
+                   .dispatch(visible.bound);
+    mp_device_scan->InclusiveSum(cmdlist, transient_view<uint>(m_transients.scan_temp), d_tile_counts, d_tile_offsets, num_tiles);
+}
+
+void GSTileSplatter::enqueue_bin_scatter(
+    Device&                   device,
+    CommandList&              cmdlist,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    GSVisibleSet              visible,
+    uint2                     grids,
+    size_t                    max_count,
+    bool                      depth_sort
+) noexcept
+{
+    auto num_tiles      = grids.x * grids.y;
+    auto capacity       = static_cast<uint>(m_point_list_capacity);
+    auto d_tile_counts  = transient_view<uint>(m_transients.tile_counts).subview(0, num_tiles);
+    auto d_tile_offsets = transient_view<uint>(m_transients.tile_offsets).subview(0, num_tiles);
+    auto d_ranges       = accel.ranges.subview(0, num_tiles * 2);
+    auto d_point_list   = transient_view<uint>(m_transients.point_list);
+    auto d_scratch      = transient_view<uint>(m_transients.point_list_unsorted);
+
+    cmdlist << (*shad_bin_ranges)(
+                   static_cast<int>(num_tiles),
+                   d_tile_counts,
+                   d_tile_offsets,
+                   d_ranges,
+                   capacity
+    )
+                   .dispatch(num_tiles);
+    cmdlist << (*shad_bin_scatter)(
+                   static_cast<int>(visible.bound),
+                   input.means_2d,
+                   input.conic,
+                   input.opacity_features,
+                   output.radii,
+                   d_tile_counts,
+                   d_tile_offsets,
+                   d_point_list,
+                   m_blocks, grids,
+                   capacity,
+                   visible.ids,
+                   visible.count,
+                   visible.compacted
+    )
+                   .dispatch(visible.bound);
+    if (!depth_sort)
+    {
+        // the weighted sum blend reads the tile lists in scatter order
+        return;
+    }
+
+    // one block per tile
+    cmdlist << (*shad_sort_tile_chunks)(
+                   d_ranges,
+                   d_point_list,
+                   input.depth_features
+    )
+                   .dispatch(num_tiles * bin_sort_block);
+
+    // merge the sorted chunks of long tiles, ping-ponging through point_list_unsorted
+    uint rounds = 0u;
+    for (size_t run = bin_sort_chunk; run < std::min(max_count, static_cast<size_t>(capacity)); run *= 2u)
+    {
+        auto src = (rounds % 2u == 0u) ? d_point_list : d_scratch;
+        auto dst = (rounds % 2u == 0u) ? d_scratch : d_point_list;
+        cmdlist << (*shad_merge_tile_runs)(
+                       d_ranges,
+                       src,
+                       dst,
+                       input.depth_features,
+                       static_cast<uint>(run)
+        )
+                       .dispatch(num_tiles * bin_sort_block);
+        rounds++;
+    }
+    if (rounds > 0u)
+    {
+        cmdlist << (*shad_resolve_tile_runs)(
+                       d_ranges,
+                       d_scratch,
+                       d_point_list,
+                       rounds
+        )
+                       .dispatch(num_tiles * bin_sort_block);
+    }
+}
+
+void GSTileSplatter::block_bitonic_sort(SmemTypePtr<uint> keys, SmemTypePtr<uint> ids, UInt n2) noexcept
+{
+    auto t = thread_id().x;
+    // ascending compare-exchange, i < j
+    auto compare_exchange = [&](UInt i, UInt j) {
+        auto ki = keys->read(i);
+        auto kj = keys->read(j);
+        $if(kj < ki)
+        {
+            keys->write(i, kj);
+            keys->write(j, ki);
+            auto id = ids->read(i);
+            ids->write(i, ids->read(j));
+            ids->write(j, id);
+        };
+    };
+
+    // the all-ascending form: a flip, then half cleaners
+    UInt k = 2u;
+    $while(k <= n2)
+    {
+        UInt half = k >> 1u;
+        $for(p, t, n2 >> 1u, bin_sort_block)
+        {
+            UInt i = (p / half) * k + (p % half);
+            compare_exchange(i, i ^ (k - 1u));
+        };
+        sync_block();
+        UInt d = half >> 1u;
+        $while(d > 0u)
+        {
+            $for(p, t, n2 >> 1u, bin_sort_block)
+            {
+                UInt i = (p / d) * (d << 1u) + (p % d);
+                compare_exchange(i, i + d);
+            };
+            sync_block();
+            d = d >> 1u;
+        };
+        k = k << 1u;
+    };
+}
+
+void GSTileSplatter::compile_binning_shader(Device& device) noexcept
+{
+    // visit the tiles of a gaussian in the same order and with the same spans as shad_allocate_tiles
+    auto for_each_touched_tile = [&](
+                                     UInt              idx,
+                                     BufferVar<float>& means_2d,
+                                     BufferVar<float>& conic,
+                                     BufferVar<float>& opacity,
+                                     BufferVar<int>&   radii,
+                                     UInt2             blocks,
+                                     UInt2             grids,
+                                     auto&&            f
+                                 ) {
+        auto radius = radii.read(idx);
+        $if(radius > 0)
+        {
+            Float2 point_xy  = read_float2(means_2d, idx);
+            Float3 con       = read_float3(conic, idx);
+            Float  threshold = (*mp_get_power_threshold)(opacity.read(idx));
+            UInt2  rect_min, rect_max;
+            (*mp_get_rect)(point_xy, radius, rect_min, rect_max, blocks, grids);
+            $for(j, rect_min.y, rect_max.y)
+            {
+                UInt x_begin, x_end;
+                (*mp_get_tile_span)(point_xy, con, threshold, j, rect_min, rect_max, blocks, x_begin, x_end);
+                $for(i, x_begin, x_end)
+                {
+                    f(i + j * grids.x);
+                };
+            };
+        };
+    };
+
+    // the gaussian behind this thread's slot of the visible list, returns for padding slots
+    auto gaussian_of_slot = [&](Int P, BufferVar<uint>& visible_ids, BufferVar<uint>& num_visible, Bool compacted) {
+        auto slot = dispatch_id().x;
+        $if(slot >= UInt(P)) { $return(); };
+        $if(compacted & (slot >= num_visible.read(0))) { $return(); };
+        UInt idx = slot;
+        $if(compacted) { idx = visible_ids.read(slot); };
+        return idx;
+    };
+
+    lazy_compile(
+        device, shad_bin_count,
+        [&](
+            Int              P,
+            BufferVar<float> means_2d,
+            BufferVar<float> conic,
+            BufferVar<float> opacity,
+            BufferVar<int>   radii,
+            BufferVar<uint>  tile_counts,
+            UInt2            blocks,
+            UInt2            grids,
+            BufferVar<uint>  visible_ids,
+            BufferVar<uint>  num_visible,
+            Bool             compacted
+        ) {
+            auto idx = gaussian_of_slot(P, visible_ids, num_visible, compacted);
+            for_each_touched_tile(idx, means_2d, conic, opacity, radii, blocks, grids, [&](UInt tile) {
+                tile_counts.atomic(tile).fetch_add(1u);
+            });
+        }
+    );
+
+    lazy_compile(
+        device, shad_bin_ranges,
+        [&](
+            Int             num_tiles,
+            BufferVar<uint> tile_counts,
+            BufferVar<uint> tile_offsets,
+            BufferVar<uint> ranges,
+            UInt            capacity
+        ) {
+            set_block_size(256);
+            auto tile = dispatch_id().x;
+            $if(tile >= UInt(num_tiles)) { $return(); };
+            // ids past the capacity are dropped by the scatter, keep the range inside point_list
+            auto end   = tile_offsets.read(tile);
+            auto begin = end - tile_counts.read(tile);
+            ranges.write(2 * tile + 0u, min(begin, capacity));
+            ranges.write(2 * tile + 1u, min(end, capacity));
+        }
+    );
+
+    lazy_compile(
+        device, shad_bin_scatter,
+        [&](
+            Int              P,
+            BufferVar<float> means_2d,
+            BufferVar<float> conic,
+            BufferVar<float> opacity,
+            BufferVar<int>   radii,
+            BufferVar<uint>  tile_counts,
+            BufferVar<uint>  tile_offsets,
+            BufferVar<uint>  point_list,
+            UInt2            blocks,
+            UInt2            grids,
+            UInt             capacity,
+            BufferVar<uint>  visible_ids,
+            BufferVar<uint>  num_visible,
+            Bool             compacted
+        ) {
+            auto idx = gaussian_of_slot(P, visible_ids, num_visible, compacted);
+            for_each_touched_tile(idx, means_2d, conic, opacity, radii, blocks, grids, [&](UInt tile) {
+                // counting down from the bucket end leaves tile_counts zeroed
+                auto slot = tile_offsets.read(tile) - tile_counts.atomic(tile).fetch_sub(1u);
+                $if(slot < capacity)
+                {
+                    point_list.write(slot, idx);
+                };
+            });
+        }
+    );
+
+    lazy_compile(
+        device, shad_sort_tile_chunks,
+        [&](BufferVar<uint> ranges, BufferVar<uint> point_list, BufferVar<float> depth_features) {
+            set_block_size(bin_sort_block);
+            auto tile  = block_id().x;
+            auto t     = thread_id().x;
+            auto begin = ranges.read(2 * tile + 0u);
+            auto end   = ranges.read(2 * tile + 1u);
+
+            Shared<uint>* keys = new Shared<uint>(bin_sort_chunk);
+            Shared<uint>* ids  = new Shared<uint>(bin_sort_chunk);
+
+            UInt num_chunks = (end - begin + bin_sort_chunk - 1u) / bin_sort_chunk;
+            $for(c, num_chunks)
+            {
+                UInt chunk_begin = begin + c * bin_sort_chunk;
+                UInt m           = min(end - chunk_begin, bin_sort_chunk);
+                UInt n2          = 2u;
+                $while(n2 < m) { n2 = n2 << 1u; };
+
+                sync_block();
+                $for(i, t, n2, bin_sort_block)
+                {
+                    $if(i < m)
+                    {
+                        auto id = point_list.read(chunk_begin + i);
+                        ids->write(i, id);
+                        // depth is positive, so its float bits keep the order
+                        keys->write(i, depth_features.read(id).as<uint>());
+                    }
+                    $else
+                    {
+                        keys->write(i, ~0u);
+                    };
+                };
+                sync_block();
+                block_bitonic_sort(keys, ids, n2);
+
+                $for(i, t, m, bin_sort_block)
+                {
+                    point_list.write(chunk_begin + i, ids->read(i));
+                };
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_merge_tile_runs,
+        [&](BufferVar<uint> ranges, BufferVar<uint> src, BufferVar<uint> dst, BufferVar<float> depth_features, UInt run) {
+            set_block_size(bin_sort_block);
+            auto tile  = block_id().x;
+            auto t     = thread_id().x;
+            auto begin = ranges.read(2 * tile + 0u);
+            auto n     = ranges.read(2 * tile + 1u) - begin;
+            // this tile was already sorted in an earlier round
+            $if(n <= run) { $return(); };
+
+            auto depth_key = [&](UInt r) {
+                return depth_features.read(src.read(begin + r)).as<uint>();
+            };
+
+            $for(r, t, n, bin_sort_block)
+            {
+                UInt run_idx   = r / run;
+                UInt pair_base = (run_idx >> 1u) * (run << 1u);
+                Bool is_left   = (run_idx & 1u) == 0u;
+                UInt other_lo  = ite(is_left, min(pair_base + run, n), pair_base);
+                UInt other_hi  = ite(is_left, min(pair_base + (run << 1u), n), pair_base + run);
+                UInt own_lo    = ite(is_left, pair_base, pair_base + run);
+                auto key       = depth_key(r);
+                // rank in the other run, ties keep the left run first
+                UInt lo = other_lo;
+                UInt hi = other_hi;
+                $while(lo < hi)
+                {
+                    UInt mid      = (lo + hi) >> 1u;
+                    auto mid_key  = depth_key(mid);
+                    Bool go_right = ite(is_left, mid_key < key, mid_key <= key);
+                    $if(go_right) { lo = mid + 1u; } $else { hi = mid; };
+                };
+                dst.write(begin + pair_base + (r - own_lo) + (lo - other_lo), src.read(begin + r));
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_resolve_tile_runs,
+        [&](BufferVar<uint> ranges, BufferVar<uint> scratch, BufferVar<uint> point_list, UInt rounds) {
+            set_block_size(bin_sort_block);
+            auto tile  = block_id().x;
+            auto t     = thread_id().x;
+            auto begin = ranges.read(2 * tile + 0u);
+            auto n     = ranges.read(2 * tile + 1u) - begin;
+            // a tile takes part in the rounds whose run is shorter than it,
+            // after an odd number of them its ids sit in the scratch buffer
+            UInt tile_rounds = 0u;
+            UInt run         = bin_sort_chunk;
+            $while((tile_rounds < rounds) & (run < n))
+            {
+                tile_rounds = tile_rounds + 1u;
+                run         = run << 1u;
+            };
+            $if((tile_rounds & 1u) == 0u) { $return(); };
+            $for(r, t, n, bin_sort_block)
+            {
+                point_list.write(begin + r, scratch.read(begin + r));
+            };
+        }
+    );
+}
+
+} // namespace lcgs
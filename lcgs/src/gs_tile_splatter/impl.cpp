@@ -16,167 +16,651 @@ using namespace luisa;
 using namespace luisa::compute;
 using namespace luisa::parallel_primitive;
 
-// Helper to convert bytes to uint count (round up)
-inline size_t bytes_to_uint_count(size_t byte_size)
+void GSTileSplatter::create(Device& device, GSTileSplatterConfig config) noexcept
 {
-    return (byte_size + sizeof(uint) - 1) / sizeof(uint);
+    m_config = config;
+    m_blocks = config.tile_size;
+    if (m_blocks.x == 0u || m_blocks.y == 0u || m_blocks.x * m_blocks.y > max_tile_threads)
+    {
+        LUISA_ERROR("GSTileSplatter: unsupported tile size {}x{}", m_blocks.x, m_blocks.y);
+    }
+    auto fp = m_config.pixels_per_thread;
+    if (fp.x == 0u || fp.y == 0u || m_blocks.x % fp.x != 0u || m_blocks.y % fp.y != 0u)
+    {
+        LUISA_ERROR("GSTileSplatter: pixels per thread {}x{} does not divide the {}x{} tile", fp.x, fp.y, m_blocks.x, m_blocks.y);
+    }
+    if (m_config.temporal_order && m_config.binning != GSTileBinning::RadixSort)
+    {
+        LUISA_WARNING("GSTileSplatter: the temporal depth order needs the radix sort binning, disabled");
+        m_config.temporal_order = false;
+    }
+    // the tile shape is baked into the kernels, every shape compiles its own variant
+    compile(device);
+    m_readback_event = luisa::make_unique<TimelineEvent>(device.create_timeline_event());
+    m_dummy_uint     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(1u));
+    // the smallest point lists, grown by the first build that needs more
+    m_point_list_capacity = m_config.point_list_min_size;
+    LUISA_INFO("Tile Splatter created with {}x{} tiles", m_blocks.x, m_blocks.y);
 }
 
-void GSTileSplatter::create(Device& device) noexcept
+size_t GSTileSplatter::plan_point_list_capacity(size_t num_rendered) noexcept
 {
-    compile(device);
-    LUISA_INFO("Tile Splatter created");
+    auto grown = std::max(static_cast<size_t>(num_rendered * m_config.point_list_headroom), static_cast<size_t>(m_config.point_list_min_size));
+    if (num_rendered > m_point_list_capacity)
+    {
+        m_point_list_idle_builds = 0u;
+        return grown;
+    }
+    // a single small frame, e.g. a look away from the scene, does not give the memory back
+    if (grown < static_cast<size_t>(m_point_list_capacity * m_config.point_list_shrink_ratio))
+    {
+        if (++m_point_list_idle_builds >= m_config.point_list_shrink_builds)
+        {
+            m_point_list_idle_builds = 0u;
+            return grown;
+        }
+    }
+    else
+    {
+        m_point_list_idle_builds = 0u;
+    }
+    return m_point_list_capacity;
 }
 
-void GSTileSplatter::ensure_scan_temp_buffer(Device& device, size_t num_items)
+GSTileSplatter::ReadbackSlot& GSTileSplatter::next_readback() noexcept
 {
-    using ScannerT = luisa::parallel_primitive::DeviceScan<>;
-    size_t temp_bytes = ScannerT::GetTempStorageBytes<uint>(num_items);
-    size_t required_uint_count = bytes_to_uint_count(temp_bytes);
-    
-    if (m_scan_temp_buffer == nullptr || m_scan_temp_buffer_size < required_uint_count)
-    {
-        // Grow the buffer: use max of required size and double current size to avoid frequent reallocations
-        size_t new_size = m_scan_temp_buffer_size == 0 ? required_uint_count : std::max(required_uint_count, m_scan_temp_buffer_size * 2);
-        m_scan_temp_buffer = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(new_size));
-        m_scan_temp_buffer_size = new_size;
-        LUISA_INFO("GSTileSplatter: scan temp buffer resized to {} uints ({} bytes)", new_size, new_size * sizeof(uint));
+    auto& slot = m_readbacks[++m_readback_fence % readback_slots];
+    // the copies of the build that had the slot before must not land in it after it is read again
+    if (slot.fence > 0u)
+    {
+        m_readback_event->synchronize(slot.fence);
     }
+    slot       = {};
+    slot.fence = m_readback_fence;
+    return slot;
 }
 
-void GSTileSplatter::ensure_radix_sort_temp_buffer(Device& device, size_t num_items)
+const GSTileSplatter::ReadbackSlot* GSTileSplatter::last_readback() const noexcept
 {
-    using RadixSorterT = luisa::parallel_primitive::DeviceRadixSort<>;
-    size_t temp_bytes = RadixSorterT::GetSortPairsTempStorageBytes<ulong, uint>(static_cast<uint>(num_items));
-    size_t required_uint_count = bytes_to_uint_count(temp_bytes);
-    
-    if (m_radix_sort_temp_buffer == nullptr || m_radix_sort_temp_buffer_size < required_uint_count)
-    {
-        // Grow the buffer: use max of required size and double current size to avoid frequent reallocations
-        size_t new_size = m_radix_sort_temp_buffer_size == 0 ? required_uint_count : std::max(required_uint_count, m_radix_sort_temp_buffer_size * 2);
-        m_radix_sort_temp_buffer = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(new_size));
-        m_radix_sort_temp_buffer_size = new_size;
-        LUISA_INFO("GSTileSplatter: radix sort temp buffer resized to {} uints ({} bytes)", new_size, new_size * sizeof(uint));
+    for (auto fence = m_readback_fence; fence > 0u && m_readback_fence - fence < readback_slots; fence--)
+    {
+        auto& slot = m_readbacks[fence % readback_slots];
+        if (slot.fence == fence && m_readback_event->is_completed(fence))
+        {
+            return &slot;
+        }
     }
+    return nullptr;
 }
 
-int GSTileSplatter::forward(
+template <typename KeyT>
+void GSTileSplatter::enqueue_sort_stages(
     Device&                   device,
-    Stream&                   stream,
+    CommandList&              cmdlist,
     GSTileSplatterAccelProxy  accel,
     GSTileSplatterInputProxy  input,
     GSSplatForwardOutputProxy output,
-    bool                      use_focal
+    GSVisibleSet              visible,
+    uint2                     grids,
+    TileKeyLayout             layout,
+    size_t                    count,
+    bool                      pad_keys
 ) noexcept
 {
-    auto width      = output.width;
-    auto height     = output.height;
-    auto resolution = luisa::make_uint2(width, height);
+    constexpr bool is_32bit = std::is_same_v<KeyT, uint>;
+    auto&          copy_with_keys = [&]() -> auto& { if constexpr (is_32bit) return shad_copy_with_keys_32; else return shad_copy_with_keys; }();
+    auto&          get_ranges     = [&]() -> auto& { if constexpr (is_32bit) return shad_get_ranges_32; else return shad_get_ranges; }();
 
-    auto grids = luisa::make_uint2(
-        (unsigned int)((width + m_blocks.x - 1u) / m_blocks.x),
-        (unsigned int)((height + m_blocks.y - 1u) / m_blocks.y)
-    );
-    LUISA_INFO("grids: ({}, {})", grids.x, grids.y);
+    // 32 bit keys live in the front half of the 64 bit key buffers
+    auto keys_unsorted = transient_view<ulong>(m_transients.keys_unsorted).template as<KeyT>().subview(0, count);
+    auto keys          = transient_view<ulong>(m_transients.keys).template as<KeyT>().subview(0, count);
+    auto d_point_list_unsorted = transient_view<uint>(m_transients.point_list_unsorted).subview(0, count);
+    auto d_point_list          = transient_view<uint>(m_transients.point_list).subview(0, count);
+    auto d_ranges              = accel.ranges.subview(0, grids.x * grids.y * 2);
 
-    int  num_gaussians   = input.num_gaussians;
-    auto d_point_offsets = accel.point_offsets.subview(0, num_gaussians);
-    auto d_tiles_touched = accel.tiles_touched.subview(0, num_gaussians);
-
-    CommandList cmdlist;
-    cmdlist
-        << (*shad_allocate_tiles)(
-               num_gaussians,
-               resolution,
-               grids,
-               input.depth_features,
-               input.means_2d,
-               input.conic,
-               d_tiles_touched,
-               output.radii,
-               use_focal
-           )
-               .dispatch(num_gaussians);
-    stream << cmdlist.commit() << synchronize();
-    
-    // Ensure scan temp buffer is large enough and perform inclusive sum
-    ensure_scan_temp_buffer(device, num_gaussians);
-    mp_device_scan->InclusiveSum(cmdlist, m_scan_temp_buffer->view(), d_tiles_touched, d_point_offsets, num_gaussians);
-    
-    cmdlist << accel.point_offsets.subview(input.num_gaussians - 1, 1).copy_to(&num_rendered);
-    stream << cmdlist.commit() << synchronize();
-
-    if (num_rendered <= 0) { return 0; }
-    LUISA_INFO("num_rendered: {}", num_rendered);
-
-    auto d_point_list_unsorted      = accel.point_list_unsorted.subview(0, num_rendered);
-    auto d_point_list_keys_unsorted = accel.point_list_keys_unsorted.subview(0, num_rendered);
-    auto d_point_list               = accel.point_list.subview(0, num_rendered);
-    auto d_point_list_keys          = accel.point_list_keys.subview(0, num_rendered);
-
-    cmdlist << mp_buffer_filler->fill(device, d_point_list_unsorted, 0u);
-    cmdlist << mp_buffer_filler->fill(device, d_point_list_keys_unsorted, 0ull);
-
-    cmdlist << (*shad_copy_with_keys)(
-                   num_gaussians,
+    if (pad_keys)
+    {
+        // unused slots keep the padding key so they sort to the back and are skipped in get_ranges
+        cmdlist << mp_buffer_filler->fill(device, keys_unsorted, static_cast<KeyT>(~KeyT{ 0 }));
+    }
+    cmdlist << (*copy_with_keys)(
+                   static_cast<int>(visible.bound),
                    input.means_2d,
-                   d_point_offsets,
+                   input.conic,
+                   input.opacity_features,
+                   accel.point_offsets,
                    output.radii,
                    input.depth_features,
-                   d_point_list_keys_unsorted,
+                   keys_unsorted,
                    d_point_list_unsorted,
-                   m_blocks, grids
+                   m_blocks, grids,
+                   static_cast<uint>(count),
+                   layout.depth_bits, layout.depth_near, layout.depth_scale,
+                   visible.ids,
+                   visible.compacted
     )
-                   .dispatch(num_gaussians);
-    stream << cmdlist.commit() << synchronize();
-    
-    // Ensure radix sort temp buffer is large enough and perform sort
-    ensure_radix_sort_temp_buffer(device, num_rendered);
-    mp_device_radix_sort->SortPairs<ulong, uint>(
+                   .dispatch(static_cast<uint>((count + key_expand_chunk - 1u) / key_expand_chunk));
+
+    mp_device_radix_sort->SortPairs<KeyT, uint>(
         cmdlist,
-        m_radix_sort_temp_buffer->view(),
-        d_point_list_keys_unsorted,
-        d_point_list_keys,
+        transient_view<uint>(m_transients.sort_temp),
+        keys_unsorted,
+        keys,
         d_point_list_unsorted,
         d_point_list,
-        num_rendered
+        static_cast<uint>(count)
     );
-    stream << cmdlist.commit() << synchronize();
-    auto d_ranges = accel.ranges.subview(0, grids.x * grids.y * 2);
-    stream << cmdlist.commit() << synchronize();
-    cmdlist << mp_buffer_filler->fill(device, d_ranges, 0u);
 
-    LUISA_INFO("get ranges");
+    cmdlist << mp_buffer_filler->fill(device, d_ranges, 0u);
     cmdlist
-        << (*shad_get_ranges)(
-               num_rendered,
-               accel.point_list_keys,
-               accel.ranges
+        << (*get_ranges)(
+               static_cast<int>(count),
+               keys,
+               d_ranges,
+               layout.depth_bits
            )
-               .dispatch(num_rendered);
+               .dispatch(static_cast<uint>(count));
+}
 
-    LUISA_INFO("forward render");
+void GSTileSplatter::enqueue_allocate(
+    CommandList&              cmdlist,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    GSVisibleSet              visible,
+    uint2                     grids,
+    bool                      use_focal
+) noexcept
+{
+    auto resolution = luisa::make_uint2(output.width, output.height);
     cmdlist
-        << (*m_forward_render_shader)(
+        << (*shad_allocate_tiles)(
+               static_cast<int>(visible.bound),
                resolution,
-               input.num_gaussians,
-               num_rendered,
-               output.target_img,
                grids,
-               input.bg_color,
-               accel.ranges,
-               accel.point_list,
+               input.depth_features,
                input.means_2d,
                input.conic,
                input.opacity_features,
-               input.color_features
+               input.color_features,
+               accel.tiles_touched,
+               output.radii,
+               accel.records,
+               visible.ids,
+               visible.count,
+               visible.compacted,
+               use_focal
            )
-               .dispatch(resolution);
+               .dispatch(visible.bound);
+}
+
+GSVisibleSet GSTileSplatter::visible_set(
+    Stream&                  stream,
+    GSTileSplatterAccelProxy accel,
+    GSTileSplatterInputProxy input,
+    ReadbackSlot&            readback,
+    const ReadbackSlot*      last
+) noexcept
+{
+    auto num_gaussians = static_cast<uint>(input.num_gaussians);
+    if (input.visible_ids.size() == 0)
+    {
+        // slots are the gaussian ids, the id and count views only stand in and never change the result
+        return { m_dummy_uint->view(), m_dummy_uint->view(), false, num_gaussians };
+    }
+    uint bound = num_gaussians;
+    if (!m_config.sync_free)
+    {
+        stream << input.num_visible.copy_to(&readback.num_visible) << synchronize();
+        bound = readback.num_visible;
+    }
+    else if (m_sync_free_capacity > 0 && last != nullptr)
+    {
+        // late like num_rendered, the frames before the first landed count walk all P slots
+        bound = static_cast<uint>(last->num_visible * m_config.sync_free_headroom);
+        bound = std::clamp(bound, std::min(m_config.sync_free_min_size, num_gaussians), num_gaussians);
+    }
+    return { input.visible_ids, input.num_visible, true, bound };
+}
+
+int GSTileSplatter::forward(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    bool                      use_focal
+) noexcept
+{
+    auto rendered = build(device, stream, accel, input, output, use_focal);
+    rasterize(device, stream, accel, { .bg_color = input.bg_color }, output);
+    return rendered;
+}
+
+void GSTileSplatter::rasterize(
+    Device&                    device,
+    Stream&                    stream,
+    GSTileSplatterAccelProxy   accel,
+    GSTileSplatterPayloadProxy payload,
+    GSSplatForwardOutputProxy  output
+) noexcept
+{
+    auto resolution = luisa::make_uint2(output.width, output.height);
+    if (resolution.x != m_built_resolution.x || resolution.y != m_built_resolution.y)
+    {
+        LUISA_ERROR("GSTileSplatter: rasterize at {}x{} over a binning built at {}x{}", resolution.x, resolution.y, m_built_resolution.x, m_built_resolution.y);
+    }
+    // unset aux outputs are never written, the target (already written by the same dispatch) or a dummy stands in for them
+    uint aux_mask = (output.alpha.size() > 0 ? aux_alpha : 0u) |
+                    (output.depth.size() > 0 ? aux_depth : 0u) |
+                    (output.median_depth.size() > 0 ? aux_median_depth : 0u) |
+                    (output.n_contrib.size() > 0 ? aux_n_contrib : 0u);
+    bool weighted_sum = m_built_blend == GSTileBlend::WeightedSum;
+    if (weighted_sum && (aux_mask & aux_median_depth))
+    {
+        // the transmittance of an unsorted list does not cross 0.5 at the median depth
+        LUISA_WARNING("GSTileSplatter: the weighted sum blend has no median depth, the output is left untouched");
+        aux_mask &= ~aux_median_depth;
+    }
+    auto aux_alpha_view   = (aux_mask & aux_alpha) ? output.alpha : output.target_img;
+    auto aux_depth_view   = (aux_mask & aux_depth) ? output.depth : output.target_img;
+    auto aux_median_view  = (aux_mask & aux_median_depth) ? output.median_depth : output.target_img;
+    auto aux_contrib_view = (aux_mask & aux_n_contrib) ? output.n_contrib : m_dummy_uint->view();
+    auto channels         = payload.features.size() == 0 ? 3u : payload.channels;
+    auto depth_falloff    = m_config.weighted_sum_depth_falloff;
+    if (payload.clear_empty_tiles)
+    {
+        stream << (*shad_fill_empty_tiles)(
+                      resolution,
+                      m_built_grids,
+                      accel.ranges,
+                      output.target_img,
+                      channels,
+                      payload.bg_color,
+                      aux_alpha_view,
+                      aux_depth_view,
+                      aux_median_view,
+                      aux_contrib_view,
+                      aux_mask
+        )
+                      .dispatch(resolution);
+    }
+    // the split tiles keep their chunks in the partial buffer, the composite blends them into the target
+    bool split = m_config.tile_split_size > 0u;
+    if (split)
+    {
+        ensure_partial_buffer(device, stream, channels);
+    }
+    auto partials_view = split ? m_partials->view() : output.target_img;
+    auto composite     = [&] {
+        if (!split) { return; }
+        stream << (*shad_composite_split_tiles)(
+                      resolution,
+                      m_built_grids,
+                      accel.ranges,
+                      m_work_counts->view(),
+                      m_tile_splits->view(),
+                      m_split_tiles->view(),
+                      m_partials->view(),
+                      output.target_img,
+                      channels,
+                      payload.bg_color,
+                      weighted_sum,
+                      aux_alpha_view,
+                      aux_depth_view,
+                      aux_median_view,
+                      aux_contrib_view,
+                      aux_mask
+        )
+                      .dispatch(*m_composite_args);
+    };
+    // the render blocks pull the work items off the queue, every rasterize starts it over
+    // only the blocks of the work items are launched, their count never leaves the device
+    stream << mp_buffer_filler->fill(device, m_work_counts->view(5u, 1u), 0u);
+    if (payload.features.size() == 0)
+    {
+        auto& shader = weighted_sum ? m_weighted_sum_render_shader : m_forward_render_shader;
+        stream
+            << (*shader)(
+                   resolution,
+                   m_built_gaussians,
+                   m_built_count,
+                   output.target_img,
+                   m_built_grids,
+                   payload.bg_color,
+                   accel.ranges,
+                   m_work_items->view(),
+                   m_work_counts->view(),
+                   m_tile_splits->view(),
+                   partials_view,
+                   transient_view<uint>(m_transients.point_list),
+                   accel.records,
+                   aux_alpha_view,
+                   aux_depth_view,
+                   aux_median_view,
+                   aux_contrib_view,
+                   aux_mask,
+                   depth_falloff
+               )
+                   .dispatch(*m_render_args);
+        composite();
+        return;
+    }
+
+    auto slot = static_cast<size_t>(std::find(feature_channels.begin(), feature_channels.end(), payload.channels) - feature_channels.begin());
+    if (slot == feature_channels.size())
+    {
+        LUISA_ERROR("GSTileSplatter: no render kernel for a {} channel payload", payload.channels);
+    }
+    if (payload.features.size() < static_cast<size_t>(payload.channels) * m_built_gaussians ||
+        output.target_img.size() < static_cast<size_t>(payload.channels) * resolution.x * resolution.y)
+    {
+        LUISA_ERROR("GSTileSplatter: the features or the target image are too small for {} channels", payload.channels);
+    }
+    compile_feature_render_shader(device, slot, weighted_sum);
+    auto& shader = weighted_sum ? m_feature_weighted_sum_shaders[slot] : m_feature_render_shaders[slot];
+    stream
+        << (*shader)(
+               resolution,
+               m_built_gaussians,
+               m_built_count,
+               output.target_img,
+               m_built_grids,
+               payload.bg_color,
+               accel.ranges,
+               m_work_items->view(),
+               m_work_counts->view(),
+               m_tile_splits->view(),
+               partials_view,
+               transient_view<uint>(m_transients.point_list),
+               accel.records,
+               payload.features,
+               aux_alpha_view,
+               aux_depth_view,
+               aux_median_view,
+               aux_contrib_view,
+               aux_mask,
+               depth_falloff
+           )
+               .dispatch(*m_render_args);
+    composite();
+}
+
+int GSTileSplatter::build(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    bool                      use_focal
+) noexcept
+{
+    AllocateStage allocate{
+        .enqueue = [this, use_focal](CommandList& cmdlist, GSTileSplatterAccelProxy accel, GSTileSplatterInputProxy input, GSSplatForwardOutputProxy output, GSVisibleSet visible, uint2 grids) {
+            enqueue_allocate(cmdlist, accel, input, output, visible, grids, use_focal);
+        },
+        .depth_ready = true
+    };
+    return build_staged(device, stream, accel, input, output, allocate);
+}
+
+int GSTileSplatter::build_staged(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    const AllocateStage&      allocate
+) noexcept
+{
+    if (m_config.sync_free)
+    {
+        return build_sync_free(device, stream, accel, input, output, allocate);
+    }
+
+    auto width      = output.width;
+    auto height     = output.height;
+    auto resolution = luisa::make_uint2(width, height);
+
+    auto grids = luisa::make_uint2(
+        (unsigned int)((width + m_blocks.x - 1u) / m_blocks.x),
+        (unsigned int)((height + m_blocks.y - 1u) / m_blocks.y)
+    );
+    LUISA_INFO("grids: ({}, {})", grids.x, grids.y);
+    m_built_resolution = resolution;
+    m_built_grids      = grids;
+    m_built_gaussians  = input.num_gaussians;
+    m_built_count      = 0;
+    m_built_blend      = input.blend;
+    auto num_tiles     = grids.x * grids.y;
+    bool sort_free     = input.blend == GSTileBlend::WeightedSum;
+    // the weighted sum needs the tile lists but not their order, the counting sort bins them without a sort
+    bool bin_by_tile = m_config.binning == GSTileBinning::CountingSort || sort_free;
+    bool temporal    = m_config.temporal_order && allocate.depth_ready && !sort_free;
+    // the temporal order hands the depth order to the slots, the keys only carry the tile
+    auto layout = temporal ? make_tile_only_key_layout(num_tiles) : make_tile_key_layout(num_tiles, m_config.depth_bits, m_config.depth_near, m_config.depth_far);
+
+    ensure_transient_arena(device, stream, input.num_gaussians, num_tiles);
+    auto  last     = last_readback();
+    auto& readback = next_readback();
+
+    // per-gaussian stages walk the slots of the visible list
+    auto visible = visible_set(stream, accel, input, readback, last);
+    if (visible.bound == 0u)
+    {
+        // empty ranges, a rasterize over this build only draws the background
+        CommandList cmdlist;
+        cmdlist << mp_buffer_filler->fill(device, accel.ranges.subview(0, num_tiles * 2), 0u);
+        enqueue_active_tiles(device, cmdlist, accel, grids);
+        stream << cmdlist.commit() << m_readback_event->signal(readback.fence);
+        num_rendered = 0;
+        return 0;
+    }
+    int  num_slots       = static_cast<int>(visible.bound);
+    auto d_point_offsets = accel.point_offsets.subview(0, num_slots);
+    auto d_tiles_touched = accel.tiles_touched.subview(0, num_slots);
+
+    CommandList cmdlist;
+    if (temporal)
+    {
+        check_temporal_order(input.num_gaussians, last);
+        visible = enqueue_temporal_order(device, cmdlist, input, visible, readback);
+    }
+    if (visible.compacted)
+    {
+        // culled gaussians are never visited
+        cmdlist << mp_buffer_filler->fill(device, output.radii, 0);
+    }
+    allocate.enqueue(cmdlist, accel, input, output, visible, grids);
+
+    if (bin_by_tile)
+    {
+        enqueue_bin_count(device, cmdlist, input, output, visible, grids);
+        cmdlist << transient_view<uint>(m_transients.tile_offsets).subview(num_tiles - 1, 1).copy_to(&num_rendered);
+    }
+    else
+    {
+        mp_device_scan->InclusiveSum(cmdlist, transient_view<uint>(m_transients.scan_temp), d_tiles_touched, d_point_offsets, num_slots);
+        cmdlist << accel.point_offsets.subview(num_slots - 1, 1).copy_to(&num_rendered);
+    }
+    stream << cmdlist.commit() << m_readback_event->signal(readback.fence) << synchronize();
+
+    if (num_rendered <= 0)
+    {
+        cmdlist << mp_buffer_filler->fill(device, accel.ranges.subview(0, num_tiles * 2), 0u);
+        enqueue_active_tiles(device, cmdlist, accel, grids);
+        stream << cmdlist.commit();
+        return 0;
+    }
+    LUISA_INFO("num_rendered: {}", num_rendered);
+    m_built_count = num_rendered;
+    // the stream is idle after the readback, the arena can be re-planned for the new capacity
+    m_point_list_capacity = plan_point_list_capacity(num_rendered);
+    if (ensure_transient_arena(device, stream, input.num_gaussians, num_tiles) && bin_by_tile)
+    {
+        // the tile bins lived in the old arena
+        enqueue_bin_count(device, cmdlist, input, output, visible, grids);
+    }
+
+    if (bin_by_tile)
+    {
+        enqueue_bin_scatter(device, cmdlist, accel, input, output, visible, grids, num_rendered, !sort_free);
+    }
+    else if (layout.fits_32bit())
+    {
+        enqueue_sort_stages<uint>(device, cmdlist, accel, input, output, visible, grids, layout, num_rendered, false);
+    }
+    else
+    {
+        enqueue_sort_stages<ulong>(device, cmdlist, accel, input, output, visible, grids, layout, num_rendered, false);
+    }
+    enqueue_active_tiles(device, cmdlist, accel, grids);
 
-    // stream << cmdlist.commit() << synchronize();
     stream << cmdlist.commit();
 
     return num_rendered;
 }
 
-} // namespace lcgs
\ No newline at end of file
+int GSTileSplatter::build_sync_free(
+    Device&                   device,
+    Stream&                   stream,
+    GSTileSplatterAccelProxy  accel,
+    GSTileSplatterInputProxy  input,
+    GSSplatForwardOutputProxy output,
+    const AllocateStage&      allocate,
+    bool                      rerun
+) noexcept
+{
+    auto width      = output.width;
+    auto height     = output.height;
+    auto resolution = luisa::make_uint2(width, height);
+
+    auto grids = luisa::make_uint2(
+        (unsigned int)((width + m_blocks.x - 1u) / m_blocks.x),
+        (unsigned int)((height + m_blocks.y - 1u) / m_blocks.y)
+    );
+    auto num_tiles     = grids.x * grids.y;
+    bool sort_free     = input.blend == GSTileBlend::WeightedSum;
+    bool bin_by_tile   = m_config.binning == GSTileBinning::CountingSort || sort_free;
+    bool temporal      = m_config.temporal_order && allocate.depth_ready && !sort_free;
+    m_built_resolution = resolution;
+    m_built_grids      = grids;
+    m_built_gaussians  = input.num_gaussians;
+    m_built_blend      = input.blend;
+    auto layout        = temporal ? make_tile_only_key_layout(num_tiles) : make_tile_key_layout(num_tiles, m_config.depth_bits, m_config.depth_near, m_config.depth_far);
+
+    // the newest count that has landed, usually last frame's, older while that frame is still in flight
+    auto  last     = last_readback();
+    auto& readback = next_readback();
+    num_rendered   = last != nullptr ? static_cast<int>(last->num_rendered) : 0;
+    if (!rerun && last != nullptr && static_cast<size_t>(num_rendered) > last->rendered_bound)
+    {
+        // copy_with_keys and the scatter dropped the pairs past the bound, nothing was written out of range
+        LUISA_WARNING("GSTileSplatter: a recent frame needed {} point list entries, {} were kept", num_rendered, last->rendered_bound);
+    }
+
+    auto visible         = visible_set(stream, accel, input, readback, last);
+    int  num_slots       = static_cast<int>(visible.bound);
+    auto d_point_offsets = accel.point_offsets.subview(0, num_slots);
+    auto d_tiles_touched = accel.tiles_touched.subview(0, num_slots);
+    // the visible gaussians past the slots walked by that frame were never allocated and are missing from it
+    readback.visible_bound = visible.bound;
+    bool visible_overflow = last != nullptr && last->num_visible > last->visible_bound;
+    if (visible_overflow && !rerun)
+    {
+        LUISA_WARNING("GSTileSplatter: a recent frame had {} visible gaussians, {} slots were walked", last->num_visible, last->visible_bound);
+    }
+
+    // upper bound of this frame's num_rendered, keys beyond it are dropped for one frame
+    // the first frames have no count yet and start from the current capacity
+    size_t bound    = m_point_list_capacity;
+    size_t capacity = m_point_list_capacity;
+    if (m_sync_free_capacity > 0 && last != nullptr)
+    {
+        bound = std::max(static_cast<size_t>(num_rendered * m_config.sync_free_headroom), static_cast<size_t>(m_config.sync_free_min_size));
+        // the point lists add their own headroom to the count, they only have to hold the sort bound on top
+        capacity = std::max(plan_point_list_capacity(num_rendered), bound);
+    }
+    bool grown = bound > m_sync_free_capacity || capacity != m_point_list_capacity;
+    // the tile binning keeps every pair that fits the point lists, the radix sort only the first bound keys
+    size_t kept = bin_by_tile ? capacity : bound;
+    // after an overflow this frame checks its own count, so a visible set that keeps growing is built again
+    if (m_work_items == nullptr || m_work_list_tiles < num_tiles || visible_overflow)
+    {
+        grown = true;
+    }
+    if (temporal)
+    {
+        check_temporal_order(input.num_gaussians, last);
+    }
+    if (grown)
+    {
+        // resizing releases buffers that may still be in flight
+        stream << synchronize();
+        m_sync_free_capacity  = std::max(bound, m_sync_free_capacity);
+        m_point_list_capacity = capacity;
+    }
+    // re-planned on a new capacity, gaussian or tile count, after waiting for the frames in flight
+    ensure_transient_arena(device, stream, input.num_gaussians, num_tiles);
+
+    CommandList cmdlist;
+    if (visible.compacted)
+    {
+        cmdlist << mp_buffer_filler->fill(device, output.radii, 0)
+                << input.num_visible.copy_to(&readback.num_visible);
+    }
+    if (temporal)
+    {
+        visible = enqueue_temporal_order(device, cmdlist, input, visible, readback);
+    }
+    allocate.enqueue(cmdlist, accel, input, output, visible, grids);
+    if (bin_by_tile)
+    {
+        // tile buckets are exact, only the ids past the capacity are dropped
+        enqueue_bin_count(device, cmdlist, input, output, visible, grids);
+        cmdlist << transient_view<uint>(m_transients.tile_offsets).subview(num_tiles - 1, 1).copy_to(&readback.num_rendered);
+        enqueue_bin_scatter(device, cmdlist, accel, input, output, visible, grids, capacity, !sort_free);
+    }
+    else
+    {
+        mp_device_scan->InclusiveSum(cmdlist, transient_view<uint>(m_transients.scan_temp), d_tiles_touched, d_point_offsets, num_slots);
+        cmdlist << accel.point_offsets.subview(num_slots - 1, 1).copy_to(&readback.num_rendered);
+        if (layout.fits_32bit())
+        {
+            enqueue_sort_stages<uint>(device, cmdlist, accel, input, output, visible, grids, layout, bound, true);
+        }
+        else
+        {
+            enqueue_sort_stages<ulong>(device, cmdlist, accel, input, output, visible, grids, layout, bound, true);
+        }
+    }
+
+    enqueue_active_tiles(device, cmdlist, accel, grids);
+
+    m_built_count           = static_cast<int>(kept);
+    readback.rendered_bound = kept;
+    // the host reads the slot only after the device passed this signal
+    stream << cmdlist.commit() << m_readback_event->signal(readback.fence);
+    if (grown)
+    {
+        // wait once so the next frame is sized by a valid count instead of the full capacity
+        stream << synchronize();
+        num_rendered = static_cast<int>(readback.num_rendered);
+        if (static_cast<size_t>(num_rendered) > kept && m_config.point_list_rerun_on_overflow)
+        {
+            // the count is known now, the second pass is sized by it and fits
+            LUISA_INFO("GSTileSplatter: {} point list entries overflowed the bound of {}, building again", num_rendered, kept);
+            return build_sync_free(device, stream, accel, input, output, allocate, true);
+        }
+        if (readback.num_visible > visible.bound && m_config.point_list_rerun_on_overflow)
+        {
+            // num_rendered only counts the walked slots, the second pass walks all visible ones
+            LUISA_INFO("GSTileSplatter: {} visible gaussians overflowed the bound of {} slots, building again", readback.num_visible, visible.bound);
+            return build_sync_free(device, stream, accel, input, output, allocate, true);
+        }
+    }
+
+    return num_rendered;
+}
+
+} // namespace lcgs
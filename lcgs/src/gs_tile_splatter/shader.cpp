@@ -15,68 +15,141 @@ void GSTileSplatter::compile(Device& device) noexcept
 {
     GSModule::compile_callables(device);
     compile_impl_shader(device);
+    compile_binning_shader(device);
+    compile_temporal_shader(device);
+    compile_active_tile_shader(device);
     compile_forward_shader(device);
 }
 
-void GSTileSplatter::compile_impl_shader(Device& device) noexcept
+template <typename KeyT>
+void GSTileSplatter::compile_key_shaders(
+    Device&                      device,
+    U<CopyWithKeysShader<KeyT>>& copy_with_keys,
+    U<GetRangesShader<KeyT>>&    get_ranges
+) noexcept
 {
     using namespace luisa;
     using namespace luisa::compute;
+    // padding key of the sync-free path, sorts behind every valid key
+    constexpr KeyT pad_key = ~KeyT{ 0 };
 
     lazy_compile(
-        device, shad_copy_with_keys,
+        device, copy_with_keys,
         [&](
             Int              P,
             BufferVar<float> points_xy,       // P x 2
+            BufferVar<float> conic,           // P x 3
+            BufferVar<float> opacity,         // P x 1
             BufferVar<uint>  offsets,         // P x 1
             BufferVar<int>   radii,           // P x 1
             BufferVar<float> depth_features,  // P x 1
-            BufferVar<ulong> keys_unsorted,   // L x 1
+            BufferVar<KeyT>  keys_unsorted,   // L x 1
             BufferVar<uint>  values_unsorted, // L x 1
             UInt2            blocks,
-            UInt2            grids
+            UInt2            grids,
+            UInt             capacity,
+            UInt             depth_bits,
+            Float            depth_near,
+            Float            depth_scale,
+            BufferVar<uint>  visible_ids,     // P x 1
+            Bool             compacted
         ) {
-            auto idx = dispatch_id().x;
-            $if(idx >= UInt(P)) { $return(); };
-            auto radius = radii.read(idx);
-            $if(radius <= 0) { $return(); };
-            // generate key/value
-            UInt off = 0u;
-            $if(idx >= 1u)
+            // each thread expands a fixed chunk of output slots, so a splat covering
+            // many tiles is spread over many threads instead of serializing one
+            UInt total = min(offsets.read(P - 1), capacity);
+            UInt off   = dispatch_id().x * key_expand_chunk;
+            $if(off >= total) { $return(); };
+            UInt off_end = min(off + key_expand_chunk, total);
+
+            // the gaussian owning slot off is the first whose inclusive offset exceeds it
+            UInt lo = 0u;
+            UInt hi = UInt(P);
+            $while(lo < hi)
+            {
+                UInt mid = (lo + hi) >> 1u;
+                $if(offsets.read(mid) <= off) { lo = mid + 1u; } $else { hi = mid; };
+            };
+            UInt slot = lo;
+            UInt skip = off;
+            $if(slot >= 1u)
             {
-                off = offsets.read(idx - 1);
+                skip = off - offsets.read(slot - 1);
             };
 
-            Float2 point_xy = read_float2(points_xy, idx);
-            UInt2  rect_min, rect_max;
+            $while(off < off_end)
+            {
+                UInt idx = slot;
+                $if(compacted) { idx = visible_ids.read(slot); };
+                Float2 point_xy  = read_float2(points_xy, idx);
+                Float3 con       = read_float3(conic, idx);
+                Float  threshold = (*mp_get_power_threshold)(opacity.read(idx));
+                UInt2  rect_min, rect_max;
+
+                (*mp_get_rect)(point_xy, radii.read(idx), rect_min, rect_max, blocks, grids);
+                // depth is positive, so its float bits keep the order, narrower fields take its log level
+                // tile-only keys (depth_bits = 0) take the depth order from the slot order
+                Float     depth     = depth_features.read(idx);
+                Var<KeyT> depth_key = Var<KeyT>(depth.as<UInt>());
+                $if(depth_bits == 0u)
+                {
+                    depth_key = Var<KeyT>(0u);
+                }
+                $else
+                {
+                    $if(depth_bits < 32u)
+                    {
+                        UInt  max_level = (1u << depth_bits) - 1u;
+                        Float level     = log(max(depth, depth_near) / depth_near) * depth_scale;
+                        level           = min(level, cast<float>(max_level));
+                        depth_key       = Var<KeyT>(min(cast<uint>(level), max_level));
+                    };
+                };
 
-            (*mp_get_rect)(point_xy, radius, rect_min, rect_max, blocks, grids);
+                $for(j, rect_min.y, rect_max.y)
+                {
+                    // same spans as shad_allocate_tiles, so exactly tiles_touched keys are emitted
+                    UInt x_begin, x_end;
+                    (*mp_get_tile_span)(point_xy, con, threshold, j, rect_min, rect_max, blocks, x_begin, x_end);
+                    UInt width = x_end - x_begin;
+                    $if(skip >= width)
+                    {
+                        skip = skip - width;
+                    }
+                    $else
+                    {
+                        UInt i = x_begin + skip;
+                        skip   = 0u;
+                        $while((i < x_end) & (off < off_end))
+                        {
+                            Var<KeyT> key = (Var<KeyT>(i + j * grids.x) << Var<KeyT>(depth_bits)) | depth_key;
+                            keys_unsorted.write(off, key);
+                            values_unsorted.write(off, idx);
+                            off = off + 1u;
+                            i   = i + 1u;
+                        };
+                    };
+                    $if(off >= off_end) { $break; };
+                };
 
-            $for(j, rect_min.y, rect_max.y)
-            {
-                $for(i, rect_min.x, rect_max.x)
+                // move on to the next gaussian that emits keys
+                slot = slot + 1u;
+                $while((slot < UInt(P)) & (offsets.read(slot) <= off))
                 {
-                    ULong key = ULong(i + j * grids.x);
-                    key <<= 32ull;
-                    auto depth = depth_features.read(idx);
-                    key |= ULong(depth.as<UInt>()) & 0x00000000FFFFFFFFull;
-                    keys_unsorted.write(off, key);
-                    values_unsorted.write(off, idx);
-                    off = off + 1u;
+                    slot = slot + 1u;
                 };
             };
         }
     );
 
     lazy_compile(
-        device, shad_get_ranges,
-        [&](Int L, BufferVar<ulong> point_list_keys, BufferVar<uint> ranges) {
+        device, get_ranges,
+        [&](Int L, BufferVar<KeyT> point_list_keys, BufferVar<uint> ranges, UInt depth_bits) {
             set_block_size(256);
             UInt idx = dispatch_id().x;
             $if(idx >= L) { $return(); };
-            ULong key       = point_list_keys.read(idx);
-            UInt  curr_tile = UInt(key >> 32ull);
-            UInt  prev_tile = 0u;
+            Var<KeyT> key = point_list_keys.read(idx);
+            $if(key == pad_key) { $return(); };
+            UInt curr_tile = UInt(key >> Var<KeyT>(depth_bits));
 
             $if(idx == 0u)
             {
@@ -84,40 +157,108 @@ void GSTileSplatter::compile_impl_shader(Device& device) noexcept
             }
             $else
             {
-                ULong prev_key  = point_list_keys.read(idx - 1);
-                UInt  prev_tile = UInt(prev_key >> 32ull);
+                UInt prev_tile = UInt(point_list_keys.read(idx - 1) >> Var<KeyT>(depth_bits));
                 $if(curr_tile != prev_tile)
                 {
-                    ranges.write(2 * prev_tile + 1u, idx);
                     ranges.write(2 * curr_tile + 0u, idx);
                 };
             };
             $if(idx == L - 1)
             {
                 ranges.write(2 * curr_tile + 1u, UInt(L));
+            }
+            $else
+            {
+                UInt next_tile = UInt(point_list_keys.read(idx + 1) >> Var<KeyT>(depth_bits));
+                $if(curr_tile != next_tile)
+                {
+                    ranges.write(2 * curr_tile + 1u, idx + 1u);
+                };
+            };
+        }
+    );
+}
+
+void GSTileSplatter::compile_impl_shader(Device& device) noexcept
+{
+    using namespace luisa;
+    using namespace luisa::compute;
+
+    compile_key_shaders<ulong>(device, shad_copy_with_keys, shad_get_ranges);
+    compile_key_shaders<uint>(device, shad_copy_with_keys_32, shad_get_ranges_32);
+
+    mp_splat_footprint = luisa::make_unique<Callable<void(float2, float3, float, uint2, float3&, int&, uint&)>>(
+        [&](
+            Float2  point_image,
+            Float3  cov_2d_in,
+            Float   opacity,
+            UInt2   grids,
+            Float3& conic,
+            Int&    radius,
+            UInt&   N_tiles_touched
+        ) {
+            conic           = make_float3(0.0f);
+            radius          = 0;
+            N_tiles_touched = 0u;
+            // low-pass filter
+            Float3 cov_2d = cov_2d_in;
+            cov_2d.x += 0.3f;
+            cov_2d.z += 0.3f;
+
+            Float det     = cov_2d.x * cov_2d.z - cov_2d.y * cov_2d.y;
+            Float inv_det = 1.0f / (det + 1e-6f);
+            conic         = inv_det * make_float3(cov_2d.z, -cov_2d.y, cov_2d.x);
+            Float mid     = 0.5f * (cov_2d.x + cov_2d.z);
+            Float lambda1 = mid + sqrt(max(0.1f, mid * mid - det));
+            Float lambda2 = mid - sqrt(max(0.1f, mid * mid - det));
+            // extent of the level set where the splat still passes the alpha cut of the blend loop
+            Float threshold = (*mp_get_power_threshold)(opacity);
+            $if(threshold <= 0.0f) { $return(); };
+            Int my_radius = ceil(sqrt(threshold * max(lambda1, lambda2)));
+
+            UInt2 rect_min, rect_max;
+            (*mp_get_rect)(point_image, my_radius, rect_min, rect_max, m_blocks, grids);
+            // only count the tiles of the rect that the ellipse actually covers
+            $for(j, rect_min.y, rect_max.y)
+            {
+                UInt x_begin, x_end;
+                (*mp_get_tile_span)(point_image, conic, threshold, j, rect_min, rect_max, m_blocks, x_begin, x_end);
+                N_tiles_touched += x_end - x_begin;
             };
+            radius = my_radius;
         }
     );
 
     lazy_compile(
         device, shad_allocate_tiles,
         [&](
-            Int              P,
-            UInt2            resolution,
-            UInt2            grids,
-            BufferVar<float> depth_features,
-            BufferVar<float> means_2d,
-            BufferVar<float> covs_2d,
-            BufferVar<uint>  tiles_touched,
-            BufferVar<int>   radii,
-            Bool             use_focal
+            Int                      P,
+            UInt2                    resolution,
+            UInt2                    grids,
+            BufferVar<float>         depth_features,
+            BufferVar<float>         means_2d,
+            BufferVar<float>         covs_2d,
+            BufferVar<float>         opacity_features,
+            BufferVar<float>         color_features,
+            BufferVar<uint>          tiles_touched,
+            BufferVar<int>           radii,
+            BufferVar<GSSplatRecord> records,
+            BufferVar<uint>          visible_ids,
+            BufferVar<uint>          num_visible,
+            Bool                     compacted,
+            Bool                     use_focal
         ) {
             set_block_size(m_blocks.x * m_blocks.y);
-            auto idx = dispatch_id().x;
-            $if(idx >= UInt(P)) { $return(); };
+            // per-gaussian accel buffers are indexed by the slot in the visible list
+            auto slot = dispatch_id().x;
+            $if(slot >= UInt(P)) { $return(); };
+            tiles_touched.write(slot, 0u);
+            // slots past the device count only pad the sync-free bound
+            $if(compacted & (slot >= num_visible.read(0))) { $return(); };
+            UInt idx = slot;
+            $if(compacted) { idx = visible_ids.read(slot); };
             // -----------------------------
             radii.write(idx, 0);
-            tiles_touched.write(idx, 0u);
 
             // near culling
             auto depth = depth_features.read(idx);
@@ -135,157 +276,422 @@ void GSTileSplatter::compile_impl_shader(Device& device) noexcept
                 cov_2d.y = cov_2d.y * resolution.x * resolution.y * 0.25f;
                 cov_2d.z = cov_2d.z * resolution.y * resolution.x * 0.25f;
             };
-            // low-pass filter
-            cov_2d.x += 0.3f;
-            cov_2d.z += 0.3f;
-
-            Float  det       = cov_2d.x * cov_2d.z - cov_2d.y * cov_2d.y;
-            Float  inv_det   = 1.0f / (det + 1e-6f);
-            Float3 conic     = inv_det * make_float3(cov_2d.z, -cov_2d.y, cov_2d.x);
-            Float  mid       = 0.5f * (cov_2d.x + cov_2d.z);
-            Float  lambda1   = mid + sqrt(max(0.1f, mid * mid - det));
-            Float  lambda2   = mid - sqrt(max(0.1f, mid * mid - det));
-            Int    my_radius = ceil(3.0f * sqrt(max(lambda1, lambda2)));
-
-            UInt2 rect_min, rect_max;
-
-            auto point_image = make_float2((*mp_ndc2pix)(point_image_ndc.x, resolution.x), (*mp_ndc2pix)(point_image_ndc.y, resolution.y));
-            (*mp_get_rect)(point_image, my_radius, rect_min, rect_max, m_blocks, grids);
-            auto N_tiles_touched = (rect_max.x - rect_min.x) * (rect_max.y - rect_min.y);
+            auto   point_image = make_float2((*mp_ndc2pix)(point_image_ndc.x, resolution.x), (*mp_ndc2pix)(point_image_ndc.y, resolution.y));
+            Float  opacity     = opacity_features.read(idx);
+            Float3 conic;
+            Int    my_radius;
+            UInt   N_tiles_touched;
+            (*mp_splat_footprint)(point_image, cov_2d, opacity, grids, conic, my_radius, N_tiles_touched);
+            $if(my_radius <= 0) { $return(); };
 
             // write out
             radii.write(idx, my_radius);
-            tiles_touched.write(idx, N_tiles_touched);
+            tiles_touched.write(slot, N_tiles_touched);
             // here we write the inverse of cov2d back to cov2d
             write_float3(covs_2d, idx, conic);
             write_float2(means_2d, idx, point_image);
+            Var<GSSplatRecord> record;
+            record.conic_opacity = make_float4(conic, opacity);
+            record.color         = read_float3(color_features, idx);
+            record.mean          = point_image;
+            record.depth         = depth;
+            records.write(idx, record);
         }
     );
     compile_forward_shader(device);
 }
 
-void GSTileSplatter::compile_forward_shader(Device& device) noexcept
+template <typename LoadPayload, typename StorePixel>
+void GSTileSplatter::blend_tile(
+    luisa::compute::UInt2                     resolution,
+    luisa::compute::UInt2                     grids,
+    luisa::compute::BufferVar<uint>&          ranges,
+    luisa::compute::BufferVar<uint>&          work_items,
+    luisa::compute::BufferVar<uint>&          work_counts,
+    luisa::compute::BufferVar<uint>&          tile_splits,
+    luisa::compute::BufferVar<float>&         partials,
+    luisa::compute::BufferVar<uint>&          point_list,
+    luisa::compute::BufferVar<GSSplatRecord>& records,
+    luisa::compute::BufferVar<float>&         alpha_out,
+    luisa::compute::BufferVar<float>&         depth_out,
+    luisa::compute::BufferVar<float>&         median_depth_out,
+    luisa::compute::BufferVar<uint>&          n_contrib_out,
+    luisa::compute::UInt                      aux_mask,
+    uint                                      channels,
+    bool                                      weighted_sum,
+    luisa::compute::Float                     depth_falloff,
+    LoadPayload&&                             load_payload,
+    StorePixel&&                              store_pixel
+) noexcept
 {
     using namespace luisa;
     using namespace luisa::compute;
-    lazy_compile(
-        device,
-        m_forward_render_shader,
-        [&](
-            UInt2 resolution,
-            Int P, Int L, // for check and debug
-            // output
-            BufferVar<float> target_img,
-            // params
-            UInt2  grids,
-            Float3 bg_color,
-            // input buffers
-            BufferVar<uint>  ranges,           // W x H x 2
-            BufferVar<uint>  point_list,       // L
-            BufferVar<float> means_2d,         // 2 * P
-            BufferVar<float> conic,            // 3 * P
-            BufferVar<float> opacity_features, // P
-            BufferVar<float> color_features    // 3 * P
-        ) {
-            set_block_size(m_blocks);
-            auto xy         = dispatch_id().xy();
-            auto w          = resolution.x;
-            auto h          = resolution.y;
-            auto thread_idx = thread_id().x + thread_id().y * block_size().x;
-            Bool inside     = Bool(xy.x < resolution.x) & Bool(xy.y < resolution.y);
-            Bool done       = !inside;
-            auto pix_id     = xy.x + resolution.x * xy.y;
-            auto pix_f      = Float2(
-                static_cast<Float>(xy.x),
-                static_cast<Float>(xy.y)
-            );
-
-            auto tile_xy     = block_id();
-            UInt tile_id     = tile_xy.x + tile_xy.y * grids.x;
-            UInt range_start = ranges.read(2 * tile_id + 0u);
-            UInt range_end   = ranges.read(2 * tile_id + 1u);
-
-            const size_t shared_mem_size = m_blocks.x * m_blocks.y;
-            const UInt   round_step      = (UInt)shared_mem_size;
-            const UInt   rounds          = ((range_end - range_start + round_step - 1u) / round_step);
-            UInt         todo            = range_end - range_start;
-
-            Shared<uint>*   collected_ids           = new Shared<uint>(shared_mem_size);
-            Shared<float2>* collected_means         = new Shared<float2>(shared_mem_size);
-            Shared<float4>* collected_conic_opacity = new Shared<float4>(shared_mem_size);
-
-            Float  T                = 1.0f;
-            Float3 C                = make_float3(0.0f, 0.0f, 0.0f);
-            UInt   contributor      = 0u;
-            UInt   last_contributor = 0u;
-
-            // Float3 white            = make_float3(1.0f, 1.0f, 1.0f);
-            // Float3 black            = make_float3(0.0f, 0.0f, 0.0f);
-            // Bool   is_black         = (tile_xy.x + tile_xy.y) % 2 == 0;
-
-            $for(i, rounds)
+    // each thread shades a footprint of fp.x x fp.y pixels, the block still covers one tile
+    const uint2 fp          = m_config.pixels_per_thread;
+    const uint  n           = fp.x * fp.y;
+    const uint  num_threads = (m_blocks.x / fp.x) * (m_blocks.y / fp.y);
+    // splats staged per round, wide payloads stage fewer to stay inside the shared memory budget
+    const uint round_size = std::min(num_threads, render_shared_bytes / static_cast<uint>(sizeof(float2) + sizeof(float4) + (channels + 1u) * sizeof(float)));
+    set_block_size(m_blocks / fp);
+    auto thread_idx = thread_id().x + thread_id().y * block_size().x;
+
+    Shared<float2>* collected_means         = new Shared<float2>(round_size);
+    Shared<float4>* collected_conic_opacity = new Shared<float4>(round_size);
+    Shared<float>*  collected_depths        = new Shared<float>(round_size);
+    // channel-major, so the threads of a round store and read neighbouring words
+    Shared<float>* collected_payload = new Shared<float>(round_size * channels);
+    Shared<uint>*  num_done          = new Shared<uint>(1);
+    Shared<uint>*  queue_slot        = new Shared<uint>(1);
+
+    // blocks pull items off the queue until it is drained, heaviest first, see shad_order_work_queue
+    // without persistent blocks there is a block per item, a block may still take two when another starts late
+    // the padding blocks of the last row of the dispatch never pull, so at most persistent_blocks are at work
+    $if(block_id().x + block_id().y * grids.x >= work_counts.read(6u)) { $return(); };
+    $loop
+    {
+        // the whole block is done with the last item and its staged splats
+        sync_block();
+        $if(thread_idx == 0u) { queue_slot->write(0u, work_counts.atomic(5u).fetch_add(1u)); };
+        sync_block();
+        UInt item_idx = queue_slot->read(0u);
+        $if(item_idx >= work_counts.read(0)) { $break; };
+        UInt tile_id    = work_items.read(2u * item_idx + 0u);
+        UInt chunk      = work_items.read(2u * item_idx + 1u);
+        UInt split_base = tile_splits.read(2u * tile_id + 0u);
+        UInt chunks     = tile_splits.read(2u * tile_id + 1u);
+
+        auto w          = resolution.x;
+        auto h          = resolution.y;
+        auto tile_xy    = make_uint2(tile_id % grids.x, tile_id / grids.x);
+        auto base_xy    = tile_xy * m_blocks + thread_id().xy() * fp;
+        auto base_f     = Float2(
+            static_cast<Float>(base_xy.x),
+            static_cast<Float>(base_xy.y)
+        );
+
+        luisa::vector<Bool>                 inside;
+        luisa::vector<Bool>                 done;
+        luisa::vector<Float>                T;
+        luisa::vector<luisa::vector<Float>> C;
+        // aux terms, cheap enough to track whether or not they are written
+        luisa::vector<Float> D;
+        luisa::vector<Float> median;
+        luisa::vector<UInt>  last_contrib;
+        luisa::vector<Float> W; // weighted sum: the sum of the splat weights
+        // split chunks: the depths where T dropped below the median steps, see shad_composite_split_tiles
+        luisa::vector<luisa::vector<Float>> steps;
+        Bool                                track_steps = (split_base != ~0u) & ((aux_mask & aux_median_depth) != 0u);
+        for (auto k = 0u; k < n; k++)
+        {
+            auto xy = base_xy + make_uint2(k % fp.x, k / fp.x);
+            inside.emplace_back(Bool(xy.x < w) & Bool(xy.y < h));
+            done.emplace_back(!inside[k]);
+            T.emplace_back(1.0f);
+            D.emplace_back(0.0f);
+            median.emplace_back(0.0f);
+            last_contrib.emplace_back(0u);
+            W.emplace_back(0.0f);
+            auto& step_depths = steps.emplace_back();
+            for (auto s = 0u; s < median_steps; s++)
+            {
+                step_depths.emplace_back(0.0f);
+            }
+            auto& acc = C.emplace_back();
+            for (auto c = 0u; c < channels; c++)
             {
-                sync_block();
-                // collect num_done
+                acc.emplace_back(0.0f);
+            }
+        }
+        auto all_done = [&] {
+            Bool all = done[0];
+            for (auto k = 1u; k < n; k++)
+            {
+                all = all & done[k];
+            }
+            return all;
+        };
+
+        // a chunk of a split tile blends its share of the list from T = 1, a whole tile is its only chunk
+        UInt tile_start   = ranges.read(2 * tile_id + 0u);
+        UInt tile_end     = ranges.read(2 * tile_id + 1u);
+        UInt chunk_len    = (tile_end - tile_start + chunks - 1u) / chunks;
+        UInt range_start  = min(tile_start + chunk * chunk_len, tile_end);
+        UInt range_end    = min(range_start + chunk_len, tile_end);
+        UInt chunk_offset = range_start - tile_start;
+
+        const UInt round_step = round_size;
+        const UInt rounds     = ((range_end - range_start + round_step - 1u) / round_step);
+        UInt       todo       = range_end - range_start;
+
+        $for(i, rounds)
+        {
+            sync_block();
+            // collect num_done, the whole tile leaves once every thread is saturated
+            $if(thread_idx == 0u) { num_done->write(0u, 0u); };
+            sync_block();
+            $if(all_done()) { num_done->atomic(0u).fetch_add(1u); };
+            sync_block();
+            $if(num_done->read(0u) == num_threads) { $break; };
+
+            Int progress = i * round_step + thread_idx;
+            $if((thread_idx < round_step) & (progress + range_start < range_end))
+            {
+                UInt coll_id = point_list.read(progress + range_start);
+                // one record read per splat, the payload is loaded next to it
+                auto record = records.read(coll_id);
+                collected_means->write(thread_idx, record.mean);
+                collected_conic_opacity->write(thread_idx, record.conic_opacity);
+                collected_depths->write(thread_idx, record.depth);
+                luisa::vector<Float> payload;
+                for (auto c = 0u; c < channels; c++)
+                {
+                    payload.emplace_back(0.0f);
+                }
+                load_payload(coll_id, record, payload);
+                for (auto c = 0u; c < channels; c++)
+                {
+                    collected_payload->write(c * round_size + thread_idx, payload[c]);
+                }
+            };
+            sync_block();
 
-                Int progress = i * round_step + thread_idx;
-                $if(progress + range_start < range_end)
+            $for(j, min(round_step, todo))
+            {
+                $if(all_done()) { $break; }; // inside or filled
+                // splat terms loaded once and shared by the pixels of the footprint
+                Float2 d0    = collected_means->read(j) - base_f;
+                Float4 con_o = collected_conic_opacity->read(j);
+                Float  z     = collected_depths->read(j);
+                luisa::vector<Float> feat;
+                for (auto c = 0u; c < channels; c++)
                 {
-                    UInt coll_id = point_list.read(progress + range_start);
-                    collected_ids->write(thread_idx, coll_id);
-                    Float2 means = read_float2(means_2d, coll_id);
-                    collected_means->write(thread_idx, means);
-                    Float  opacity       = opacity_features.read(coll_id);
-                    Float4 conic_opacity = make_float4(
-                        conic.read(3 * coll_id + 0),
-                        conic.read(3 * coll_id + 1),
-                        conic.read(3 * coll_id + 2),
-                        opacity
-                    );
-                    collected_conic_opacity->write(thread_idx, conic_opacity);
-                };
-                sync_block();
+                    feat.emplace_back(collected_payload->read(c * round_size + j));
+                }
 
-                $for(j, min(round_step, todo))
+                for (auto k = 0u; k < n; k++)
                 {
-                    $if(done) { $break; }; // inside or filled
-                    contributor  = contributor + 1u;
-                    Float2 mean  = collected_means->read(j);
-                    Float2 d     = mean - pix_f;
-                    Float4 con_o = collected_conic_opacity->read(j);
-
-                    Float power = -0.5f * (con_o.x * d.x * d.x + con_o.z * d.y * d.y) - con_o.y * d.x * d.y;
-                    $if(power > 0.0f) { $continue; };
-                    Float alpha = min(0.99f, con_o.w * exp(power));
-                    $if(alpha < 1.0f / 255.0f) { $continue; };
-                    Float test_T = T * (1.0f - alpha);
-                    $if(test_T < 0.0001f)
+                    $if(!done[k])
                     {
-                        done = true;
-                        $continue;
+                        Float2 d     = d0 - make_float2(static_cast<float>(k % fp.x), static_cast<float>(k / fp.x));
+                        Float  power = -0.5f * (con_o.x * d.x * d.x + con_o.z * d.y * d.y) - con_o.y * d.x * d.y;
+                        Float  alpha = min(0.99f, con_o.w * exp(power));
+                        $if((power <= 0.0f) & (alpha >= 1.0f / 255.0f))
+                        {
+                            if (weighted_sum)
+                            {
+                                // the sums and the product of (1 - alpha) are the same in any list order,
+                                // no pixel saturates early, the whole list is blended, there is no median
+                                Float weight = alpha * exp(-depth_falloff * z);
+                                for (auto c = 0u; c < channels; c++)
+                                {
+                                    C[k][c] = C[k][c] + weight * feat[c];
+                                }
+                                D[k]            = D[k] + weight * z;
+                                W[k]            = W[k] + weight;
+                                T[k]            = T[k] * (1.0f - alpha);
+                                last_contrib[k] = chunk_offset + i * round_step + j + 1u;
+                            }
+                            else
+                            {
+                                Float test_T = T[k] * (1.0f - alpha);
+                                $if((T[k] > 0.5f) & (test_T <= 0.5f)) { median[k] = z; };
+                                $if(track_steps)
+                                {
+                                    for (auto s = 0u; s < median_steps; s++)
+                                    {
+                                        float step = 1.0f - static_cast<float>(s) / (2.0f * median_steps);
+                                        $if((T[k] >= step) & (test_T < step)) { steps[k][s] = z; };
+                                    }
+                                };
+                                $if(test_T < 0.0001f)
+                                {
+                                    done[k] = true;
+                                }
+                                $else
+                                {
+                                    Float weight = T[k] * alpha;
+                                    for (auto c = 0u; c < channels; c++)
+                                    {
+                                        C[k][c] = C[k][c] + weight * feat[c];
+                                    }
+                                    D[k]            = D[k] + weight * z;
+                                    T[k]            = test_T;
+                                    last_contrib[k] = chunk_offset + i * round_step + j + 1u;
+                                };
+                            }
+                        };
                     };
-
-                    auto   id   = collected_ids->read(j);
-                    Float3 feat = read_float3(color_features, id);
-
-                    C                = C + T * alpha * feat;
-                    T                = test_T;
-                    last_contributor = contributor;
-                };
-
-                todo = todo - round_step;
+                }
             };
 
-            $if(inside)
+            todo = todo - round_step;
+        };
+
+        for (auto k = 0u; k < n; k++)
+        {
+            auto xy = base_xy + make_uint2(k % fp.x, k / fp.x);
+            $if(inside[k])
             {
-                auto color = bg_color * T + C;
-                $for(i, 0, 3)
+                $if(split_base != ~0u)
                 {
-                    target_img.write(pix_id + i * h * w, color[i]);
+                    // the raw sums of the chunk, channel after channel, then T, D, W, median, the last contributor
+                    // and the depths of the median steps
+                    const uint stride      = channels + partial_fields;
+                    const uint tile_pixels = m_blocks.x * m_blocks.y;
+                    auto       local_xy    = xy - tile_xy * m_blocks;
+                    auto       local_id    = local_xy.x + local_xy.y * m_blocks.x;
+                    auto       slot        = split_base + chunk;
+                    auto       write       = [&](uint f, Float v) { partials.write((slot * stride + f) * tile_pixels + local_id, v); };
+                    for (auto c = 0u; c < channels; c++)
+                    {
+                        write(c, C[k][c]);
+                    }
+                    write(channels + 0u, T[k]);
+                    write(channels + 1u, D[k]);
+                    write(channels + 2u, W[k]);
+                    write(channels + 3u, median[k]);
+                    write(channels + 4u, cast<float>(last_contrib[k]));
+                    for (auto s = 0u; s < median_steps; s++)
+                    {
+                        write(channels + 5u + s, steps[k][s]);
+                    }
+                }
+                $else
+                {
+                    auto  pix_id = xy.x + w * xy.y;
+                    Float a      = 1.0f - T[k];
+                    if (weighted_sum)
+                    {
+                        // the normalized weighted color covers 1 - T of the pixel, the background the rest
+                        Float scale = ite(W[k] > 0.0f, a / W[k], 0.0f);
+                        for (auto c = 0u; c < channels; c++)
+                        {
+                            C[k][c] = C[k][c] * scale;
+                        }
+                        D[k] = D[k] * scale;
+                    }
+                    store_pixel(pix_id, T[k], C[k]);
+                    $if((aux_mask & aux_alpha) != 0u) { alpha_out.write(pix_id, a); };
+                    $if((aux_mask & aux_depth) != 0u) { depth_out.write(pix_id, ite(a > 0.0f, D[k] / a, 0.0f)); };
+                    $if((aux_mask & aux_median_depth) != 0u) { median_depth_out.write(pix_id, median[k]); };
+                    $if((aux_mask & aux_n_contrib) != 0u) { n_contrib_out.write(pix_id, last_contrib[k]); };
                 };
             };
         }
+    };
+}
+
+void GSTileSplatter::compile_forward_shader(Device& device) noexcept
+{
+    using namespace luisa;
+    using namespace luisa::compute;
+    // the weighted sum variant blends every splat of the tile list with the weight
+    // alpha * exp(-falloff * z) and composites the normalized sum over the background
+    // by the transmittance prod(1 - alpha), neither depends on the order of the list
+    auto compile_variant = [&](U<RecordRenderShader>& shader, bool weighted_sum) {
+        lazy_compile(
+            device,
+            shader,
+            [&](
+                UInt2 resolution,
+                Int P, Int L, // for check and debug
+                // output
+                BufferVar<float> target_img,
+                // params
+                UInt2  grids,
+                Float3 bg_color,
+                // input buffers
+                BufferVar<uint>          ranges,       // W x H x 2
+                BufferVar<uint>          work_items,   // 2 x items
+                BufferVar<uint>          work_counts,  // 7
+                BufferVar<uint>          tile_splits,  // W x H x 2
+                BufferVar<float>         partials,     // split chunks x (channels + partial_fields) x tile pixels
+                BufferVar<uint>          point_list,   // L
+                BufferVar<GSSplatRecord> records,      // P
+                // aux outputs
+                BufferVar<float> alpha,
+                BufferVar<float> depth,
+                BufferVar<float> median_depth,
+                BufferVar<uint>  n_contrib,
+                UInt             aux_mask,
+                Float            depth_falloff
+            ) {
+                auto n_pixels = resolution.x * resolution.y;
+                blend_tile(
+                    resolution, grids, ranges, work_items, work_counts, tile_splits, partials, point_list, records,
+                    alpha, depth, median_depth, n_contrib, aux_mask, 3u, weighted_sum, depth_falloff,
+                    [&](UInt, Var<GSSplatRecord>& record, luisa::vector<Float>& payload) {
+                        payload[0] = record.color.x;
+                        payload[1] = record.color.y;
+                        payload[2] = record.color.z;
+                    },
+                    [&](UInt pix_id, Float T, luisa::vector<Float>& C) {
+                        for (auto c = 0u; c < 3u; c++)
+                        {
+                            target_img.write(pix_id + c * n_pixels, bg_color[c] * T + C[c]);
+                        }
+                    }
+                );
+            }
+        );
+    };
+    compile_variant(m_forward_render_shader, false);
+    compile_variant(m_weighted_sum_render_shader, true);
+}
+
+void GSTileSplatter::compile_feature_render_shader(Device& device, size_t slot, bool weighted_sum) noexcept
+{
+    using namespace luisa;
+    using namespace luisa::compute;
+    auto& shader = weighted_sum ? m_feature_weighted_sum_shaders[slot] : m_feature_render_shaders[slot];
+    if (shader != nullptr) { return; }
+    const uint channels = feature_channels[slot];
+    lazy_compile(
+        device,
+        shader,
+        [&](
+            UInt2                    resolution,
+            Int                      P,
+            Int                      L,
+            BufferVar<float>         target_img,
+            UInt2                    grids,
+            Float3                   bg_color,
+            BufferVar<uint>          ranges,
+            BufferVar<uint>          work_items,
+            BufferVar<uint>          work_counts,
+            BufferVar<uint>          tile_splits,
+            BufferVar<float>         partials,
+            BufferVar<uint>          point_list,
+            BufferVar<GSSplatRecord> records,
+            BufferVar<float>         features,
+            BufferVar<float>         alpha,
+            BufferVar<float>         depth,
+            BufferVar<float>         median_depth,
+            BufferVar<uint>          n_contrib,
+            UInt                     aux_mask,
+            Float                    depth_falloff
+        ) {
+            auto n_pixels = resolution.x * resolution.y;
+            blend_tile(
+                resolution, grids, ranges, work_items, work_counts, tile_splits, partials, point_list, records,
+                alpha, depth, median_depth, n_contrib, aux_mask, channels, weighted_sum, depth_falloff,
+                [&](UInt coll_id, Var<GSSplatRecord>&, luisa::vector<Float>& payload) {
+                    for (auto c = 0u; c < channels; c++)
+                    {
+                        payload[c] = features.read(coll_id * channels + c);
+                    }
+                },
+                [&](UInt pix_id, Float T, luisa::vector<Float>& C) {
+                    for (auto c = 0u; c < channels; c++)
+                    {
+                        Float bg = c < 3u ? bg_color[c] : Float(0.0f);
+                        target_img.write(pix_id + c * n_pixels, bg * T + C[c]);
+                    }
+                }
+            );
+        }
     );
+    LUISA_INFO("GSTileSplatter: compiled the {} channel {} render kernel", channels, weighted_sum ? "weighted sum" : "sorted");
 }
 
-} // namespace lcgs
\ No newline at end of file
+} // namespace lcgs
@@ -0,0 +1,231 @@
+/**
+ * @file gs_tile_splatter/temporal.cpp
+ * @brief The Temporal Depth Order for the Gaussian Tile Splatter
+ */
+
+#include "lcgs/gs_tile_splatter.h"
+#include "lcgs/core/sugar.h"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+
+void GSTileSplatter::ensure_temporal_buffers(Device& device, size_t num_gaussians)
+{
+    if (m_depth_order == nullptr || m_depth_order->size() != num_gaussians)
+    {
+        m_depth_order     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(num_gaussians));
+        m_order_keys      = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(num_gaussians));
+        m_order_scratch   = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(num_gaussians));
+        m_order_stats     = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(2u));
+        m_temporal_seeded = false;
+        LUISA_INFO("GSTileSplatter: temporal order buffers resized to {} gaussians", num_gaussians);
+    }
+}
+
+void GSTileSplatter::check_temporal_order(size_t num_gaussians, const ReadbackSlot* last) noexcept
+{
+    // the inversions left by the newest landed repair, a large camera motion leaves many of them
+    if (last == nullptr) { return; }
+    auto max_inversions = static_cast<size_t>(m_config.temporal_max_unsorted * num_gaussians);
+    if (m_temporal_seeded && last->order_inversions > max_inversions)
+    {
+        LUISA_INFO("GSTileSplatter: {} inversions left in the depth order, re-seeding", last->order_inversions);
+        m_temporal_seeded = false;
+    }
+}
+
+GSVisibleSet GSTileSplatter::enqueue_temporal_order(
+    Device&                  device,
+    CommandList&             cmdlist,
+    GSTileSplatterInputProxy input,
+    GSVisibleSet             visible,
+    ReadbackSlot&            readback
+) noexcept
+{
+    auto P = static_cast<uint>(input.num_gaussians);
+    ensure_temporal_buffers(device, P);
+    auto d_order         = m_depth_order->view(0, P);
+    auto d_keys          = m_order_keys->view(0, P);
+    auto d_scratch       = m_order_scratch->view(0, P);
+    auto d_scratch_keys  = transient_view<uint>(m_transients.order_scratch_keys).subview(0, P);
+    auto d_offsets       = transient_view<uint>(m_transients.order_offsets).subview(0, P);
+    auto d_inversions    = m_order_stats->view(0, 1);
+    auto d_ordered_count = m_order_stats->view(1, 1);
+
+    cmdlist << mp_buffer_filler->fill(device, d_inversions, 0u);
+    if (!m_temporal_seeded)
+    {
+        // full depth sort of all gaussians
+        cmdlist << (*shad_order_seed)(static_cast<int>(P), d_order).dispatch(P);
+        cmdlist << (*shad_order_gather)(static_cast<int>(P), d_order, input.depth_features, d_keys).dispatch(P);
+        mp_device_radix_sort->SortPairs<uint, uint>(
+            cmdlist,
+            transient_view<uint>(m_transients.order_sort_temp),
+            d_keys,
+            d_scratch_keys,
+            d_order,
+            d_scratch,
+            P
+        );
+        cmdlist << d_order.copy_from(d_scratch)
+                << d_keys.copy_from(d_scratch_keys);
+        m_temporal_seeded = true;
+    }
+    else
+    {
+        // last frame's order with this frame's depth, repaired inside windows
+        cmdlist << (*shad_order_gather)(static_cast<int>(P), d_order, input.depth_features, d_keys).dispatch(P);
+        for (uint pass = 0u; pass < m_config.temporal_fixup_passes; pass++)
+        {
+            uint offset      = (pass % 2u == 0u) ? 0u : bin_sort_chunk / 2u;
+            uint num_windows = offset >= P ? 0u : (P - offset + bin_sort_chunk - 1u) / bin_sort_chunk;
+            if (num_windows == 0u) { continue; }
+            cmdlist << (*shad_order_fixup)(static_cast<int>(P), d_order, d_keys, offset).dispatch(num_windows * bin_sort_block);
+        }
+        cmdlist << (*shad_order_count_inversions)(static_cast<int>(P), d_keys, m_order_stats->view()).dispatch(P);
+    }
+    cmdlist << d_inversions.copy_to(&readback.order_inversions);
+
+    // keep the visible gaussians in rank order, the slots then walk them front to back
+    if (visible.compacted)
+    {
+        cmdlist << mp_buffer_filler->fill(device, d_scratch, 0u);
+        cmdlist << (*shad_order_mark)(
+                       static_cast<int>(visible.bound),
+                       visible.ids,
+                       visible.count,
+                       d_scratch
+        )
+                       .dispatch(visible.bound);
+    }
+    cmdlist << (*shad_order_rank_flags)(static_cast<int>(P), d_order, d_scratch, d_scratch_keys, visible.compacted).dispatch(P);
+    mp_device_scan->InclusiveSum(cmdlist, transient_view<uint>(m_transients.scan_temp), d_scratch_keys, d_offsets, P);
+    cmdlist << (*shad_order_compact)(
+                   static_cast<int>(P),
+                   d_order,
+                   d_scratch_keys,
+                   d_offsets,
+                   d_scratch,
+                   m_order_stats->view()
+    )
+                   .dispatch(P);
+
+    return { d_scratch, d_ordered_count, true, visible.bound };
+}
+
+void GSTileSplatter::compile_temporal_shader(Device& device) noexcept
+{
+    lazy_compile(
+        device, shad_order_seed,
+        [&](Int P, BufferVar<uint> order) {
+            set_block_size(256);
+            auto r = dispatch_id().x;
+            $if(r >= UInt(P)) { $return(); };
+            order.write(r, r);
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_gather,
+        [&](Int P, BufferVar<uint> order, BufferVar<float> depth_features, BufferVar<uint> keys) {
+            set_block_size(256);
+            auto r = dispatch_id().x;
+            $if(r >= UInt(P)) { $return(); };
+            // positive depths keep their order as float bits, gaussians behind the camera sort to the back
+            keys.write(r, depth_features.read(order.read(r)).as<uint>());
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_fixup,
+        [&](Int P, BufferVar<uint> order, BufferVar<uint> keys, UInt offset) {
+            set_block_size(bin_sort_block);
+            auto t     = thread_id().x;
+            UInt begin = offset + block_id().x * bin_sort_chunk;
+            $if(begin >= UInt(P)) { $return(); };
+            UInt m  = min(UInt(P) - begin, bin_sort_chunk);
+            UInt n2 = 2u;
+            $while(n2 < m) { n2 = n2 << 1u; };
+
+            Shared<uint>* window_keys = new Shared<uint>(bin_sort_chunk);
+            Shared<uint>* window_ids  = new Shared<uint>(bin_sort_chunk);
+            $for(i, t, n2, bin_sort_block)
+            {
+                $if(i < m)
+                {
+                    window_keys->write(i, keys.read(begin + i));
+                    window_ids->write(i, order.read(begin + i));
+                }
+                $else
+                {
+                    window_keys->write(i, ~0u);
+                };
+            };
+            sync_block();
+            block_bitonic_sort(window_keys, window_ids, n2);
+            $for(i, t, m, bin_sort_block)
+            {
+                keys.write(begin + i, window_keys->read(i));
+                order.write(begin + i, window_ids->read(i));
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_count_inversions,
+        [&](Int P, BufferVar<uint> keys, BufferVar<uint> stats) {
+            set_block_size(256);
+            auto r = dispatch_id().x;
+            $if(r + 1u >= UInt(P)) { $return(); };
+            $if(keys.read(r) > keys.read(r + 1u))
+            {
+                stats.atomic(0).fetch_add(1u);
+            };
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_mark,
+        [&](Int num_slots, BufferVar<uint> visible_ids, BufferVar<uint> num_visible, BufferVar<uint> flags) {
+            set_block_size(256);
+            auto slot = dispatch_id().x;
+            $if((slot >= UInt(num_slots)) | (slot >= num_visible.read(0))) { $return(); };
+            flags.write(visible_ids.read(slot), 1u);
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_rank_flags,
+        [&](Int P, BufferVar<uint> order, BufferVar<uint> flags, BufferVar<uint> rank_flags, Bool compacted) {
+            set_block_size(256);
+            auto r = dispatch_id().x;
+            $if(r >= UInt(P)) { $return(); };
+            UInt flag = 1u;
+            $if(compacted) { flag = flags.read(order.read(r)); };
+            rank_flags.write(r, flag);
+        }
+    );
+
+    lazy_compile(
+        device, shad_order_compact,
+        [&](Int P, BufferVar<uint> order, BufferVar<uint> rank_flags, BufferVar<uint> offsets, BufferVar<uint> ordered_ids, BufferVar<uint> stats) {
+            set_block_size(256);
+            auto r = dispatch_id().x;
+            $if(r >= UInt(P)) { $return(); };
+            auto offset = offsets.read(r);
+            $if(rank_flags.read(r) != 0u)
+            {
+                ordered_ids.write(offset - 1u, order.read(r));
+            };
+            $if(r == UInt(P) - 1u)
+            {
+                stats.write(1, offset);
+            };
+        }
+    );
+}
+
+} // namespace lcgs
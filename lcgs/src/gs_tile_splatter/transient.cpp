@@ -0,0 +1,80 @@
+/**
+ * @file gs_tile_splatter/transient.cpp
+ * @brief The Transient Arena of the Gaussian Tile Splatter
+ */
+
+#include "lcgs/gs_tile_splatter.h"
+
+namespace lcgs
+{
+
+using namespace luisa;
+using namespace luisa::compute;
+using namespace luisa::parallel_primitive;
+
+namespace
+{
+
+// the stages of one build, in submission order
+enum TransientStage : uint32_t
+{
+    stage_order    = 0, // temporal depth order
+    stage_allocate = 1, // allocate_tiles
+    stage_count    = 2, // scan of tiles_touched, or the per-tile histogram
+    stage_expand   = 3, // copy_with_keys
+    stage_sort     = 4, // radix sort of the keys
+    stage_ranges   = 5, // get_ranges, or the bin scatter and the per-tile sorts
+    stage_render   = 6  // every rasterize until the next build
+};
+
+} // namespace
+
+bool GSTileSplatter::ensure_transient_arena(Device& device, Stream& stream, size_t num_gaussians, size_t num_tiles)
+{
+    auto capacity = m_point_list_capacity;
+    if (m_transient_arena != nullptr && num_gaussians == m_planned_gaussians && num_tiles == m_planned_tiles && capacity == m_planned_capacity)
+    {
+        return false;
+    }
+    bool counting_sort = m_config.binning == GSTileBinning::CountingSort;
+    bool temporal      = m_config.temporal_order;
+
+    m_transient_plan.clear();
+    m_transients = {};
+    auto& ids    = m_transients;
+    // the scan runs over the gaussians (or their slots), the tile binning scans the tiles as well
+    auto scan_items = std::max(num_gaussians, num_tiles);
+    ids.scan_temp   = m_transient_plan.add("scan_temp", DeviceScan<>::GetTempStorageBytes<uint>(scan_items), stage_order, stage_count);
+    if (temporal)
+    {
+        auto P                 = static_cast<uint>(num_gaussians);
+        ids.order_sort_temp    = m_transient_plan.add("order_sort_temp", DeviceRadixSort<>::GetSortPairsTempStorageBytes<uint, uint>(P), stage_order, stage_order);
+        ids.order_scratch_keys = m_transient_plan.add("order_scratch_keys", num_gaussians * sizeof(uint), stage_order, stage_order);
+        ids.order_offsets      = m_transient_plan.add("order_offsets", num_gaussians * sizeof(uint), stage_order, stage_order);
+    }
+    // the weighted sum builds of the radix binning bin by tile as well, the bins are small enough to always plan
+    ids.tile_counts  = m_transient_plan.add("tile_counts", num_tiles * sizeof(uint), stage_count, stage_ranges);
+    ids.tile_offsets = m_transient_plan.add("tile_offsets", num_tiles * sizeof(uint), stage_count, stage_ranges);
+    if (!counting_sort)
+    {
+        auto L        = static_cast<uint>(capacity);
+        auto sort_tmp = std::max(DeviceRadixSort<>::GetSortPairsTempStorageBytes<ulong, uint>(L), DeviceRadixSort<>::GetSortPairsTempStorageBytes<uint, uint>(L));
+        ids.keys_unsorted = m_transient_plan.add("keys_unsorted", capacity * sizeof(ulong), stage_expand, stage_sort);
+        ids.sort_temp     = m_transient_plan.add("sort_temp", sort_tmp, stage_sort, stage_sort);
+        ids.keys          = m_transient_plan.add("keys", capacity * sizeof(ulong), stage_sort, stage_ranges);
+    }
+    ids.point_list_unsorted = m_transient_plan.add("point_list_unsorted", capacity * sizeof(uint), stage_expand, stage_ranges);
+    ids.point_list          = m_transient_plan.add("point_list", capacity * sizeof(uint), stage_sort, stage_render);
+    auto arena_bytes        = m_transient_plan.plan();
+
+    // the old arena may still be read by enqueued builds and rasterizes
+    if (m_transient_arena != nullptr) { stream << synchronize(); }
+    m_transient_arena   = luisa::make_unique<Buffer<uint>>(device.create_buffer<uint>(std::max<size_t>(arena_bytes / sizeof(uint), 1u)));
+    m_planned_gaussians = num_gaussians;
+    m_planned_tiles     = num_tiles;
+    m_planned_capacity  = capacity;
+    m_transient_plan.report("GSTileSplatter");
+    return true;
+}
+
+} // namespace lcgs
@@ -26,13 +26,80 @@ void GSModule::compile_callables(Device& device) noexcept
             UInt2& rect_min,
             UInt2& rect_max,
             UInt2 blocks, UInt2 grids) {
-            // clamp
+            // clamp, rect_max is exclusive so the last tile row/column stays reachable
             rect_min = make_uint2(
-                clamp(UInt((p.x - max_radius) / blocks.x), Var(0u), grids.x - 1),
-                clamp(UInt((p.y - max_radius) / blocks.y), Var(0u), grids.y - 1));
+                UInt(clamp(Int((p.x - max_radius) / blocks.x), Int(0), Int(grids.x))),
+                UInt(clamp(Int((p.y - max_radius) / blocks.y), Int(0), Int(grids.y))));
             rect_max = make_uint2(
-                clamp(UInt(p.x + max_radius + blocks.x - 1) / blocks.x, Var(0u), grids.x - 1),
-                clamp(UInt(p.y + max_radius + blocks.y - 1) / blocks.y, Var(0u), grids.y - 1));
+                UInt(clamp(Int((p.x + max_radius + blocks.x - 1) / blocks.x), Int(0), Int(grids.x))),
+                UInt(clamp(Int((p.y + max_radius + blocks.y - 1) / blocks.y), Int(0), Int(grids.y))));
+        });
+
+    mp_get_power_threshold = luisa::make_unique<Callable<float(float)>>([](Float opacity) {
+        // opacity * exp(-q / 2) >= 1 / 255, capped at the 3-sigma ellipse
+        // non-positive when the splat can never reach the alpha cut
+        return min(2.0f * log(max(255.0f * opacity, 1e-6f)), 9.0f);
+    });
+
+    mp_get_tile_span = luisa::make_unique<Callable<void(float2, float3, float, uint, uint2, uint2, uint2, uint&, uint&)>>(
+        [](
+            Float2 p,
+            Float3 conic,
+            Float threshold,
+            UInt row,
+            UInt2 rect_min,
+            UInt2 rect_max,
+            UInt2 blocks,
+            UInt& x_begin,
+            UInt& x_end) {
+            // q(d) = a dx^2 + 2 b dx dy + c dy^2, the ellipse is q(d) <= threshold
+            auto a   = conic.x;
+            auto b   = conic.y;
+            auto c   = conic.z;
+            auto det = max(a * c - b * b, 1e-12f);
+            // half extents of the ellipse
+            auto hx = sqrt(threshold * c / det);
+            auto hy = sqrt(threshold * a / det);
+            // pixel centers of the row, relative to the mean
+            auto dy_lo = max(Float(row * blocks.y) - p.y, -hy);
+            auto dy_hi = min(Float(row * blocks.y + blocks.y - 1u) - p.y, hy);
+
+            x_begin = rect_min.x;
+            x_end   = rect_min.x;
+            $if(dy_lo <= dy_hi)
+            {
+                // the right (left) boundary x(dy) is concave (convex), take its extremum inside the row
+                auto dy_r    = clamp(-b * hx / c, dy_lo, dy_hi);
+                auto dy_l    = clamp(b * hx / c, dy_lo, dy_hi);
+                auto x_right = p.x + (-b * dy_r + sqrt(max(threshold * a - det * dy_r * dy_r, 0.0f))) / a;
+                auto x_left  = p.x + (-b * dy_l - sqrt(max(threshold * a - det * dy_l * dy_l, 0.0f))) / a;
+                // tile i covers the pixel centers [i * bx, i * bx + bx - 1]
+                auto i_begin = Int(ceil((x_left - Float(blocks.x - 1u)) / Float(blocks.x)));
+                auto i_end   = Int(floor(x_right / Float(blocks.x))) + 1;
+                x_begin      = UInt(clamp(i_begin, Int(rect_min.x), Int(rect_max.x)));
+                x_end        = UInt(clamp(i_end, Int(x_begin), Int(rect_max.x)));
+            };
+        });
+
+    mp_cam_clamp = luisa::make_unique<Callable<float3(float3, float, float)>>(
+        [](Float3 p, Float tanfovx, Float tanfovy) {
+            auto t    = p;
+            auto limx = 1.3f * tanfovx;
+            auto limy = 1.3f * tanfovy;
+            auto txtz = t.x / t.z;
+            auto tytz = t.y / t.z;
+            // use luisa::compute::clamp for CallOp::CLAMP
+            t.x = luisa::compute::clamp(txtz, -limx, limx) * t.z;
+            t.y = luisa::compute::clamp(tytz, -limy, limy) * t.z;
+            return t;
+        });
+
+    mp_outside_frustum = luisa::make_unique<Callable<bool(float3, float3, float, float)>>(
+        [](Float3 p_view, Float3 scale, Float tanx, Float tany) {
+            Float r         = 3.0f * max(max(scale.x, scale.y), scale.z);
+            Bool  outside_x = abs(p_view.x) - tanx * p_view.z > r * sqrt(1.0f + tanx * tanx);
+            Bool  outside_y = abs(p_view.y) - tany * p_view.z > r * sqrt(1.0f + tany * tany);
+            return outside_x | outside_y;
         });
 }
 
@@ -164,6 +164,16 @@ void SHProcessor::compile(Device& device) noexcept
         auto result = (*mp_compute_color_from_sh)((Int)idx, channel, deg, cam_pos, xyz, sh);
         write_float3(color, idx, result);
     });
+
+    lazy_compile(device, shad_sh_process_visible, [&](Int P, Int channel, Int deg, Float3 cam_pos, BufferVar<float> xyz, BufferVar<float> sh, BufferVar<uint> visible_ids, BufferVar<uint> num_visible, BufferVar<float> color) {
+        // the visible count only lives on device, threads past it leave before touching the 48 sh floats
+        auto slot = dispatch_id().x;
+        $if(slot >= UInt(P)) { $return(); };
+        $if(slot >= num_visible.read(0)) { $return(); };
+        Int  idx    = visible_ids.read(slot);
+        auto result = (*mp_compute_color_from_sh)(idx, channel, deg, cam_pos, xyz, sh);
+        write_float3(color, idx, result);
+    });
 }
 
 void SHProcessor::process(
@@ -187,4 +197,30 @@ void SHProcessor::process(
                .dispatch(proxy.N);
 }
 
-} // namespace lcgs
\ No newline at end of file
+void SHProcessor::process_visible(
+    CommandList&            cmdlist,
+    GPUPointsProxy          proxy,
+    lcgs::Camera&           camera,
+    BufferView<float>       sh,
+    BufferView<float>       color,
+    BufferView<luisa::uint> visible_ids,
+    BufferView<luisa::uint> num_visible,
+    int channel, int level
+) noexcept
+{
+    cmdlist
+        << (*shad_sh_process_visible)(
+               proxy.N,
+               channel,
+               level,
+               make_float3(camera.position),
+               proxy.pos,
+               sh,
+               visible_ids,
+               num_visible,
+               color
+           )
+               .dispatch(proxy.N);
+}
+
+} // namespace lcgs
@@ -0,0 +1,111 @@
+/**
+ * @file util/transient_planner.cpp
+ * @brief The Lifetime Based Placement of Transient Buffers in one Arena
+ */
+
+#include "lcgs/util/transient_planner.h"
+#include <luisa/core/logging.h>
+#include <algorithm>
+
+namespace lcgs
+{
+
+uint32_t TransientPlanner::add(luisa::string_view name, size_t bytes, uint32_t first_stage, uint32_t last_stage) noexcept
+{
+    if (first_stage > last_stage)
+    {
+        LUISA_ERROR("TransientPlanner: {} ends at stage {} before it starts at stage {}", name, last_stage, first_stage);
+    }
+    m_resources.push_back({ .name = luisa::string{ name }, .bytes = bytes, .first_stage = first_stage, .last_stage = last_stage });
+    return static_cast<uint32_t>(m_resources.size() - 1u);
+}
+
+void TransientPlanner::clear() noexcept
+{
+    m_resources.clear();
+    m_arena_bytes = 0u;
+}
+
+bool TransientPlanner::lifetimes_overlap(uint32_t a, uint32_t b) const noexcept
+{
+    auto& ra = m_resources[a];
+    auto& rb = m_resources[b];
+    return ra.first_stage <= rb.last_stage && rb.first_stage <= ra.last_stage;
+}
+
+size_t TransientPlanner::plan(size_t alignment) noexcept
+{
+    auto align_up = [alignment](size_t x) { return (x + alignment - 1u) / alignment * alignment; };
+    luisa::vector<uint32_t> order(m_resources.size());
+    for (auto i = 0u; i < order.size(); i++) { order[i] = i; }
+    // big and long-lived first, they decide the shape of the arena
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        auto& ra = m_resources[a];
+        auto& rb = m_resources[b];
+        if (ra.bytes != rb.bytes) { return ra.bytes > rb.bytes; }
+        return ra.last_stage - ra.first_stage > rb.last_stage - rb.first_stage;
+    });
+
+    m_arena_bytes = 0u;
+    luisa::vector<uint32_t> placed;
+    luisa::vector<uint32_t> live;
+    for (auto id : order)
+    {
+        // the placed resources sharing a stage with this one, by offset
+        live.clear();
+        for (auto other : placed)
+        {
+            if (lifetimes_overlap(id, other) && m_resources[other].bytes > 0u) { live.push_back(other); }
+        }
+        std::sort(live.begin(), live.end(), [&](uint32_t a, uint32_t b) { return m_resources[a].offset < m_resources[b].offset; });
+        // first gap that fits
+        size_t offset = 0u;
+        for (auto other : live)
+        {
+            auto& r = m_resources[other];
+            if (offset + m_resources[id].bytes <= r.offset) { break; }
+            offset = std::max(offset, align_up(r.offset + r.bytes));
+        }
+        m_resources[id].offset = offset;
+        m_arena_bytes          = std::max(m_arena_bytes, offset + m_resources[id].bytes);
+        placed.push_back(id);
+    }
+    m_arena_bytes = align_up(m_arena_bytes);
+    return m_arena_bytes;
+}
+
+size_t TransientPlanner::unaliased_bytes() const noexcept
+{
+    size_t sum = 0u;
+    for (auto& r : m_resources) { sum += r.bytes; }
+    return sum;
+}
+
+size_t TransientPlanner::peak_live_bytes() const noexcept
+{
+    uint32_t num_stages = 0u;
+    for (auto& r : m_resources) { num_stages = std::max(num_stages, r.last_stage + 1u); }
+    size_t peak = 0u;
+    for (auto stage = 0u; stage < num_stages; stage++)
+    {
+        size_t live = 0u;
+        for (auto& r : m_resources)
+        {
+            if (r.first_stage <= stage && stage <= r.last_stage) { live += r.bytes; }
+        }
+        peak = std::max(peak, live);
+    }
+    return peak;
+}
+
+void TransientPlanner::report(luisa::string_view owner) const noexcept
+{
+    for (auto& r : m_resources)
+    {
+        LUISA_INFO("{}: {:<20} {:>12} bytes at {:>12}, stages {}-{}", owner, r.name, r.bytes, r.offset, r.first_stage, r.last_stage);
+    }
+    LUISA_INFO("{}: arena {} MB, {} MB as separate buffers, {} MB peak live",
+               owner, m_arena_bytes >> 20u, unaliased_bytes() >> 20u, peak_live_bytes() >> 20u);
+}
+
+} // namespace lcgs
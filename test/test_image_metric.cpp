@@ -0,0 +1,38 @@
+/**
+ * @file test_image_metric.cpp
+ * @brief Image Metric Test Suite
+ */
+
+#include "test_util.h"
+#include "lcgs/util/image_metric.h"
+#include <cmath>
+#include <vector>
+
+namespace lcgs::test
+{
+
+bool test_image_psnr()
+{
+    std::vector<float> a(64, 0.5f);
+    std::vector<float> b = a;
+    CHECK(image_mse(a.data(), b.data(), a.size()) == 0.0);
+    CHECK(std::isinf(image_psnr(a.data(), b.data(), a.size())));
+
+    // a uniform error of 0.1 is an mse of 0.01, 20 dB below a peak of 1
+    for (auto& x : b) { x += 0.1f; }
+    CHECK(std::abs(image_mse(a.data(), b.data(), a.size()) - 0.01) < 1e-6);
+    CHECK(std::abs(image_psnr(a.data(), b.data(), a.size()) - 20.0) < 1e-3);
+    // the same error on a 0-255 scale
+    CHECK(std::abs(image_psnr(a.data(), b.data(), a.size(), 255.0) - (20.0 + 20.0 * std::log10(255.0))) < 1e-3);
+    return true;
+}
+
+} // namespace lcgs::test
+
+TEST_SUITE("basic")
+{
+    TEST_CASE("image-metric")
+    {
+        CHECK(lcgs::test::test_image_psnr());
+    }
+}
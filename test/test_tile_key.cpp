@@ -0,0 +1,66 @@
+/**
+ * @file test_tile_key.cpp
+ * @brief Tile Key Layout Test Suite
+ */
+
+#include "test_util.h"
+#include "lcgs/util/tile_key.h"
+
+namespace lcgs::test
+{
+
+bool test_tile_key_layout()
+{
+    // 1600x1063 with 16x16 tiles
+    auto layout = make_tile_key_layout(100u * 67u, 18u);
+    CHECK(layout.tile_bits == 13u);
+    CHECK(layout.depth_bits == 18u);
+    CHECK(layout.fits_32bit());
+
+    // the largest valid key stays below the all-ones padding key
+    uint64_t max_key = (uint64_t(100u * 67u - 1u) << layout.depth_bits) | ((1ull << layout.depth_bits) - 1ull);
+    CHECK(max_key < (1ull << layout.key_bits()) - 1ull);
+
+    // a power of two tile count needs the extra bit
+    CHECK(make_tile_key_layout(4096u, 16u).tile_bits == 13u);
+
+    // full depth precision falls back to 64 bit keys and the float bits
+    auto full = make_tile_key_layout(100u * 67u, 32u);
+    CHECK(!full.quantized());
+    CHECK(!full.fits_32bit());
+    CHECK(tile_key_depth(full, 1.0f) == 0x3f800000u);
+
+    // log levels over [near, far] keep the order of positive depths
+    CHECK(tile_key_depth(layout, 0.5f) < tile_key_depth(layout, 1.0f));
+    CHECK(tile_key_depth(layout, 1.0f) < tile_key_depth(layout, 1.01f));
+    CHECK(tile_key_depth(layout, 20.0f) < tile_key_depth(layout, 80.0f));
+    CHECK(tile_key_depth(layout, layout.depth_near) == 0u);
+    CHECK(tile_key_depth(layout, 0.01f) == 0u);
+    CHECK(tile_key_depth(layout, 1e6f) == layout.max_depth_level());
+    CHECK(tile_key_depth(layout, 80.0f) < (1u << layout.depth_bits));
+
+    // a few bits still tell a scene of 1 to 100 units apart, e.g. 8 bits give 1.5% steps up to 200
+    auto coarse = make_tile_key_layout(100u * 67u, 8u, 0.2f, 200.0f);
+    CHECK(coarse.fits_32bit());
+    CHECK(tile_key_depth(coarse, 1.0f) < tile_key_depth(coarse, 1.05f));
+    CHECK(tile_key_depth(coarse, 50.0f) < tile_key_depth(coarse, 52.5f));
+    CHECK(tile_key_depth(coarse, 200.0f) == 255u);
+
+    // tile-only keys always fit 32 bit and keep the tile as the whole key
+    auto tile_only = make_tile_only_key_layout(100u * 67u);
+    CHECK(tile_only.depth_bits == 0u);
+    CHECK(tile_only.key_bits() == 13u);
+    CHECK(tile_only.fits_32bit());
+
+    return true;
+}
+
+} // namespace lcgs::test
+
+TEST_SUITE("basic")
+{
+    TEST_CASE("tile-key-layout")
+    {
+        CHECK(lcgs::test::test_tile_key_layout());
+    }
+}
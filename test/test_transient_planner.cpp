@@ -0,0 +1,86 @@
+/**
+ * @file test_transient_planner.cpp
+ * @brief Transient Planner Test Suite
+ */
+
+#include "test_util.h"
+#include "lcgs/util/transient_planner.h"
+
+namespace lcgs::test
+{
+
+// no two resources that share a stage share a byte
+bool placement_valid(const TransientPlanner& planner)
+{
+    auto& rs = planner.resources();
+    for (auto a = 0u; a < rs.size(); a++)
+    {
+        if (rs[a].offset + rs[a].bytes > planner.arena_bytes()) { return false; }
+        for (auto b = a + 1u; b < rs.size(); b++)
+        {
+            bool bytes_overlap = rs[a].offset < rs[b].offset + rs[b].bytes && rs[b].offset < rs[a].offset + rs[a].bytes;
+            if (planner.lifetimes_overlap(a, b) && bytes_overlap) { return false; }
+        }
+    }
+    return true;
+}
+
+bool test_transient_planner_basic()
+{
+    TransientPlanner planner;
+    auto             a = planner.add("a", 1000u, 0u, 1u);
+    auto             b = planner.add("b", 1000u, 2u, 3u);
+    auto             c = planner.add("c", 100u, 1u, 2u);
+    planner.plan(256u);
+
+    // a and b never live together and share the front of the arena
+    CHECK(planner.offset(a) == planner.offset(b));
+    // c overlaps both and lands after them, aligned
+    CHECK(planner.offset(c) % 256u == 0u);
+    CHECK(planner.offset(c) >= 1000u);
+    CHECK(planner.arena_bytes() % 256u == 0u);
+    CHECK(planner.peak_live_bytes() == 1100u);
+    CHECK(planner.unaliased_bytes() == 2100u);
+    CHECK(placement_valid(planner));
+    return true;
+}
+
+bool test_transient_planner_splatting()
+{
+    // the sort phase of the tile splatter, 1M gaussians, 10M tile-splat pairs, 16x16 tiles at 1080p
+    const size_t P = 1u << 20u;
+    const size_t L = 10'000'000u;
+    const size_t T = 120u * 68u;
+    // stages: order, allocate, count, expand, sort, ranges, render
+    TransientPlanner planner;
+    planner.add("scan_temp", 4u * P / 64u, 0u, 2u);
+    planner.add("order_sort_temp", 12u * P, 0u, 0u);
+    planner.add("order_scratch_keys", 4u * P, 0u, 0u);
+    planner.add("order_offsets", 4u * P, 0u, 0u);
+    planner.add("tile_counts", 4u * T, 2u, 5u);
+    planner.add("keys_unsorted", 8u * L, 3u, 4u);
+    planner.add("point_list_unsorted", 4u * L, 3u, 5u);
+    planner.add("sort_temp", 12u * L, 4u, 4u);
+    planner.add("keys", 8u * L, 4u, 5u);
+    planner.add("point_list", 4u * L, 4u, 6u);
+    planner.plan();
+    planner.report("test");
+
+    CHECK(placement_valid(planner));
+    CHECK(planner.arena_bytes() >= planner.peak_live_bytes());
+    CHECK(planner.arena_bytes() < planner.unaliased_bytes());
+    // the temporal scratch hides inside the space of the sort
+    CHECK(planner.unaliased_bytes() - planner.arena_bytes() >= 20u * P);
+    return true;
+}
+
+} // namespace lcgs::test
+
+TEST_SUITE("basic")
+{
+    TEST_CASE("transient-planner")
+    {
+        CHECK(lcgs::test::test_transient_planner_basic());
+        CHECK(lcgs::test::test_transient_planner_splatting());
+    }
+}